@@ -1,15 +1,17 @@
 #include "Button.h"
 
+float Button::mMouseScale = 1.0f;
+
 Button::Button()
 	: mCurrentState(ButtonState::BUTTON_MOUSE_OUT),
 	  mTexture(nullptr),
 	  mButtonRect({ 0, 0, 0, 0 }),
 	  mTextureRect({0, 0, 0, 0}),
+	  mSelected(false),
 	  mMouseOutColour({ 219, 184, 215, SDL_ALPHA_OPAQUE }), // light purple
 	  mMouseOverMotionColour({ 95, 89, 191, SDL_ALPHA_OPAQUE }),//blue
 	  mMouseDownColour({ 91, 191, 116, SDL_ALPHA_OPAQUE }), // green
-	  mMouseUpColour({ 95, 89, 191, SDL_ALPHA_OPAQUE }), // blue
-	  mSelected(false)
+	  mMouseUpColour({ 95, 89, 191, SDL_ALPHA_OPAQUE }) // blue
 {
 
 }
@@ -24,6 +26,11 @@ void Button::setButtonRect(const SDL_Rect& rect)
 	mButtonRect = rect;
 }
 
+const SDL_Rect& Button::getButtonRect() const
+{
+	return mButtonRect;
+}
+
 void Button::setTextureRect(const SDL_Rect& rect)
 {
 	mTextureRect = rect;
@@ -80,9 +87,11 @@ ButtonState Button::getMouseEvent(const SDL_Event* event)
 	//If mouse event happened
 	if (event->type == SDL_MOUSEMOTION || event->type == SDL_MOUSEBUTTONDOWN || event->type == SDL_MOUSEBUTTONUP)
 	{
-		// Get mouse position
-		int x, y;
-		SDL_GetMouseState(&x, &y);
+		// Get mouse position from the event itself, so replayed events hit the buttons they were recorded on
+		int x = event->type == SDL_MOUSEMOTION ? event->motion.x : event->button.x;
+		int y = event->type == SDL_MOUSEMOTION ? event->motion.y : event->button.y;
+		x = (int)(x * mMouseScale);
+		y = (int)(y * mMouseScale);
 
 		// Mouse is outside button
 		if (!isMouseInside(x, y))
@@ -113,6 +122,11 @@ ButtonState Button::getMouseEvent(const SDL_Event* event)
 	return mCurrentState;
 }
 
+void Button::setMouseScale(const float scale)
+{
+	mMouseScale = scale;
+}
+
 void Button::setMouseDownColour(const SDL_Color& colour)
 {
 	mMouseDownColour = colour;
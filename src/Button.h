@@ -27,6 +27,9 @@ private:
 	// Has the button been selected by the mouse
 	bool mSelected;
 
+	// Scale from window coordinates to renderer pixels (greater than 1 on high-DPI displays)
+	static float mMouseScale;
+
 protected:
 	// Define button colours
 	SDL_Color mMouseOutColour;
@@ -41,8 +44,9 @@ public:
 	// Set Texture
 	void setTexture(SDL_Texture* texture);
 
-	// Set button and texture SDL_Rect
+	// Set and get button and texture SDL_Rect
 	void setButtonRect(const SDL_Rect& rect);
+	const SDL_Rect& getButtonRect() const;
 	void setTextureRect(const SDL_Rect& rect);
 
 	// Center texture onto button
@@ -57,6 +61,9 @@ public:
 	// Get mouse event
 	ButtonState getMouseEvent(const SDL_Event* event);
 
+	// Set scale from window coordinates to renderer pixels
+	static void setMouseScale(const float scale);
+
 	// Set mouse down colour
 	void setMouseDownColour(const SDL_Color& colour);
 
@@ -1,16 +1,68 @@
 ﻿#include "Sudoku.h"
 
+namespace
+{
+	// Strings rasterized into the texture cache (index 16 is the menu background, not a glyph)
+	const char* const gTextureStrings[] =
+	{
+		" ", "1", "2", "3", "4", "5", "6", "7", "8", "9",
+		"Check", "New", "Wrong!", "Right!", "Start", "Continue", nullptr, "Resume",
+		"0", ".", "Frame", "Events", "Logic", "Render", "Present", "Generate", "Min", "Avg", "P99", "ms",
+		"Hint", "Naked", "Hidden", "Locked", "Pair", "None", "Notes",
+		"Diagonal", "Windoku", "Killer", "Puzzle", "of", "Indexing"
+	};
+
+	// Name of each variant shown in the timer row (nullptr for classic)
+	const char* const gVariantNames[] = { nullptr, "Diagonal", "Windoku", "Killer" };
+
+	// Generate a Sudoku of a variant, returning the rules it was generated with
+	template <class Rules>
+	void generateVariant(const unsigned int seed, int* grid, int* solution, Rules& rules)
+	{
+		Sudoku::VariantGenerator<Rules> generator;
+		generator.setSeed(seed);
+		generator.generate(grid, solution);
+		rules = generator.getRules();
+	}
+
+	// Strings needed for the menu and the grid, rasterized before the first frame (the rest follow over the next frames)
+	const int CRITICAL_STRINGS = 18;
+
+	// Placements the watched solve makes every frame
+	const int WATCH_NODES_PER_FRAME = 2;
+
+	// Thumbnails on a page of the puzzle browser
+	const int BROWSE_COLUMNS = 4;
+	const int BROWSE_ROWS = 4;
+	const int BROWSE_PAGE = BROWSE_COLUMNS * BROWSE_ROWS;
+}
+
 Sudoku::Sudoku::Sudoku()
-	: mWindowHeight(880), mWindowWidth(720),
+	: mDesignHeight(880), mDesignWidth(720),
+	  mWindowHeight(880), mWindowWidth(720),
 	  mGridHeight(720), mGridWidth(720),
+	  mLayoutX(0), mLayoutY(0),
 	  mGridRows(9), mGridCols(9),
 	  mWindow(nullptr), mRenderer(nullptr), 
-	  mTotalTextures(14), mTextureCache{ nullptr },
+	  mTotalTextures(sizeof(gTextureStrings) / sizeof(gTextureStrings[0])), mTextureCache(nullptr),
+	  mBackgroundTexture(nullptr),
 	  mFont(nullptr), mFontSize(mGridHeight/12),
 	  mTotalCells(81),
-	  mClearColour({ 0, 0, 0, SDL_ALPHA_OPAQUE })
+	  mVariant(Variant::CLASSIC),
+	  mNotesMode(false), mNotesBoardVersion(0), mNotesAtlas(nullptr), mNotesDirty(true),
+	  mGivensLayer(nullptr), mGivensDirty(true),
+	  mWatching(false), mWatchSavedValues(),
+	  mShowPerformanceHud(false),
+	  mHintBoardVersion(0), mHintPending(false),
+	  mClearColour({ 0, 0, 0, SDL_ALPHA_OPAQUE }),
+	  mSeed(0), mSavedBoardVersion(0), mSavedElapsed(0), mRestoredElapsed(0),
+	  mBrowsing(false), mCollectionLogged(false), mBrowseSelected(0), mBrowseFirst(0)
 {
-
+	// Bind cells to the board model
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		mGrid[cell].setBoard(&mBoard, cell);
+	}
 }
 
 Sudoku::Sudoku::~Sudoku()
@@ -24,6 +76,17 @@ bool Sudoku::Sudoku::initialiseSDL()
 	// Set success initialisation flag
 	bool success = true;
 
+	// Opt in to per-monitor DPI awareness so Windows does not bitmap-stretch the window
+	SDL_SetHint(SDL_HINT_WINDOWS_DPI_AWARENESS, "permonitorv2");
+
+	// Replays run without a display, GPU or sound card unless drivers are chosen in the environment
+	if (mReplay.getMode() == ReplayMode::REPLAYING)
+	{
+		SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+		SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+	}
+
 	// Initalise SDL video subsystem
 	if (SDL_Init(SDL_INIT_VIDEO) != 0)
 	{
@@ -31,6 +94,17 @@ bool Sudoku::Sudoku::initialiseSDL()
 		success = false;
 	}
 
+	// Map the asset archive next to the executable (or in the working directory), falling back to loose files
+	char* basePath = SDL_GetBasePath();
+	const std::string base = basePath != nullptr ? basePath : "";
+	SDL_free(basePath);
+	if (!mAssets.open(base + "assets.pak") && !mAssets.open("assets.pak"))
+	{
+		std::cout << "Asset archive not found, loading loose files" << std::endl;
+	}
+	mAssets.addLooseDirectory(base + "assets/");
+	mAssets.addLooseDirectory("assets/");
+
 	// Initialise SDL_ttf
 	if (TTF_Init() == -1)
 	{
@@ -38,21 +112,34 @@ bool Sudoku::Sudoku::initialiseSDL()
 		success = false;
 	}
 
-	// Initialise SDL audio subsystem
-	if (SDL_Init(SDL_INIT_AUDIO) < 0) {
-		std::cerr << "SDL audio could not initialize! Error: " << SDL_GetError() << std::endl;
-		success = false;
+	// Audio is initialised by the audio loader thread once the first frame is shown
+
+	// Scale the design size by the display DPI (96 DPI is 100% scaling)
+	float displayDpi = 96.0f;
+	if (SDL_GetDisplayDPI(0, nullptr, &displayDpi, nullptr) != 0 || displayDpi < 96.0f)
+	{
+		displayDpi = 96.0f;
 	}
+	int windowWidth = (int)(mDesignWidth * displayDpi / 96.0f);
+	int windowHeight = (int)(mDesignHeight * displayDpi / 96.0f);
 
-	// Initialise SDL_mixer
-	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-		std::cerr << "SDL_mixer coud not initialize! Error: " << Mix_GetError() << std::endl;
-		success = false;
+	// Keep the window on screen, preserving the aspect ratio
+	SDL_Rect usableBounds;
+	if (SDL_GetDisplayUsableBounds(0, &usableBounds) == 0 && windowHeight > usableBounds.h)
+	{
+		windowWidth = windowWidth * usableBounds.h / windowHeight;
+		windowHeight = usableBounds.h;
 	}
 
+	// Replay at the window size the recording was made at, so recorded mouse positions land on the same buttons
+	if (mReplay.getMode() == ReplayMode::REPLAYING && mReplay.getWidth() > 0 && mReplay.getHeight() > 0)
+	{
+		windowWidth = mReplay.getWidth();
+		windowHeight = mReplay.getHeight();
+	}
 
 	// Create window
-	mWindow = SDL_CreateWindow("Sudoku", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, mWindowWidth, mWindowHeight, SDL_WINDOW_SHOWN);
+	mWindow = SDL_CreateWindow("Sudoku", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, windowWidth, windowHeight, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
 	if (mWindow == nullptr)
 	{
 		std::cout << "SDL could not create window! Error: " << SDL_GetError() << std::endl;
@@ -67,48 +154,20 @@ bool Sudoku::Sudoku::initialiseSDL()
 		success = false;
 	}
 
-	// Load font for text
-	mFont = TTF_OpenFont("assets/octin sports free.ttf", mFontSize);
-	if (mFont == nullptr)
-	{
-		std::cout << "Failed to load font! Error: " << TTF_GetError() << std::endl;
-		success = false;
-	}
+	// Don't let the window shrink below a usable size
+	SDL_SetWindowMinimumSize(mWindow, mDesignWidth / 2, mDesignHeight / 2);
 
-	// Load sound effect
-	soundEffect = Mix_LoadWAV("assets/effect.wav");
-	if (!soundEffect) {
-		std::cout << "Failed to load soundEffect! Error: " << Mix_GetError() << std::endl;
-		success = false;
-	}
+	// Size grid and font to the renderer output
+	updateWindowSize();
 
-	// Load music theme
-	music = Mix_LoadMUS("assets/loop_music.mp3");
-	if (!music) {
-		std::cout << "Failed to load music! Error: " << Mix_GetError() << std::endl;
-		success = false;
-	}
-	// Load new game effect
-	newLevelEffect = Mix_LoadWAV("assets/new_game.wav");
-	Mix_VolumeChunk(newLevelEffect, 50);
-	if (!newLevelEffect) {
-		std::cout << "Failed to load new level soundeffect! Error: " << Mix_GetError() << std::endl;
-		success = false;
-	}
-
-	winSoundEffect = Mix_LoadWAV("assets/win.wav");
-	if (!winSoundEffect) {
-		std::cout << "Failed to load  winSoundeffect! Error: " << Mix_GetError() << std::endl;
-		success = false;
-	}
-
-	checkSolutionSoundEffect = Mix_LoadWAV("assets/checksolution.wav");
-	Mix_VolumeChunk(checkSolutionSoundEffect, 15);
-	if (!checkSolutionSoundEffect) {
-		std::cout << "Failed to load sound effect to check solution! Error: " << Mix_GetError() << std::endl;
+	// Load font for text and rasterize textures at the current pixel size
+	mGlyphCache.initialise(mRenderer, &mAssets, "octin sports free.ttf", gTextureStrings, mTotalTextures, CRITICAL_STRINGS);
+	if (!mGlyphCache.setSize(mFontSize))
+	{
 		success = false;
 	}
-
+	mTextureCache = mGlyphCache.getTextures();
+	mFont = mGlyphCache.getFont();
 
 	return success;
 }
@@ -140,36 +199,11 @@ void Sudoku::Sudoku::loadTexture(SDL_Texture*& texture, const char* text, SDL_Co
 
 void Sudoku::Sudoku::preloadTextures()
 {
-	// Choose colour of font
-	SDL_Color fontColour = { 0, 0, 0, SDL_ALPHA_OPAQUE }; // black
-
-	// Load texture for empty space
-	loadTexture(mTextureCache[0], " ", fontColour);
-
-	// Load textures for numbers from 1 to 9
-	for (int num = 1; num < 10; num++)
-	{
-		const char temp[] = { '0' + num, '\0' };
-		loadTexture(mTextureCache[num], temp, fontColour);
-	}
-
-	// Load texture for "Check", "Solve", and "New" buttons
-	loadTexture(mTextureCache[10], "Check", fontColour);
-	loadTexture(mTextureCache[11], "New", fontColour);
-	loadTexture(mTextureCache[12], "Wrong!", fontColour);
-	loadTexture(mTextureCache[13], "Right!", fontColour);
-
-	// Load texture for start button
-	loadTexture(mTextureCache[14], "Start", fontColour);
-	// Load texture for pause button
-	loadTexture(mTextureCache[15], "Continue", fontColour);
+	// Text textures for numbers and buttons are rasterized by the glyph cache at the current font size
 
-	// Load texture for pause game button
-	loadTexture(mTextureCache[17], "Resume", fontColour);
-
-	// Load texure for the menu
+	// Load texure for the menu (a single colour, so it is stretched to any window size)
 	SDL_Texture* blueTexture = NULL;
-	SDL_Surface* surface = SDL_CreateRGBSurface(0, mWindowWidth, mWindowHeight, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, 1, 1, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
 
 	// Set blue color for the surface
 	SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 173, 216, 230));
@@ -181,30 +215,27 @@ void Sudoku::Sudoku::preloadTextures()
 	// Free surface
 	SDL_FreeSurface(surface);
 
-	// Push back texture
-	mTextureCache[16] = blueTexture;
-
-
-
-
-
-
+	// Store texture
+	mBackgroundTexture = blueTexture;
 }
 
 void Sudoku::Sudoku::createInterfaceLayout()
 {
-	// Define thick and thin borders
-	const int thinBorder = 2;
-	const int thickBorder = thinBorder + 6;
+	// Define thick and thin borders (scaled with the grid)
+	const int thinBorder = mGridWidth / 360 > 1 ? mGridWidth / 360 : 1;
+	const int thickBorder = 4 * thinBorder;
+
+	// Height of the scaled layout
+	const int layoutHeight = mGridWidth * mDesignHeight / mDesignWidth;
 
 	// Treat stopwatch as a button that can't be clicked
-	int buttonStartRow = 0;
+	int buttonStartRow = mLayoutY;
 	int buttonWidth = mGridWidth - 2 * thickBorder;
-	// mWindowHeight = buttonHeight + 6 * thinBorder + 6 * thickBorder (rearange this equation)
-	int buttonHeight = (mWindowHeight - 6 * thinBorder - 6 * thickBorder) / 11;
+	// layoutHeight = buttonHeight + 6 * thinBorder + 6 * thickBorder (rearange this equation)
+	int buttonHeight = (layoutHeight - 6 * thinBorder - 6 * thickBorder) / 11;
 
 	buttonStartRow += thickBorder;
-	int buttonStartCol = 0;
+	int buttonStartCol = mLayoutX;
 	buttonStartCol += thickBorder;
 	// Set button position and dimensions
 	SDL_Rect buttonRect = { buttonStartCol, buttonStartRow, buttonWidth, buttonHeight };
@@ -225,7 +256,7 @@ void Sudoku::Sudoku::createInterfaceLayout()
 		else buttonStartRow += buttonHeight + thinBorder;
 
 		// Reset starting column
-		int buttonStartCol = 0;
+		int buttonStartCol = mLayoutX;
 
 		for (int gridCol = 0; gridCol < mGridCols; gridCol++)
 		{
@@ -241,21 +272,22 @@ void Sudoku::Sudoku::createInterfaceLayout()
 		}
 	}
 
-	const int numberOfOtherButtons = 3;
+	const int numberOfOtherButtons = 4;
 	mCheckButton.setTexture(mTextureCache[10]);
 	mNewButton.setTexture(mTextureCache[11]);
+	mHintButton.setTexture(mTextureCache[30]);
 	mPauseGameButton.setTexture(mTextureCache[17]);
-	Button* otherButtons[numberOfOtherButtons] = { &mCheckButton, &mNewButton, &mPauseGameButton };
+	Button* otherButtons[numberOfOtherButtons] = { &mCheckButton, &mNewButton, &mHintButton, &mPauseGameButton };
 
 	// Redefine button width
-	// mGridWidth = 4 * thickBorder + 9 * numberOfOtherButtons (rearrange this equation)
-	buttonWidth = (mGridWidth - 4 * thickBorder) / numberOfOtherButtons;
+	// mGridWidth = (numberOfOtherButtons + 1) * thickBorder + numberOfOtherButtons * buttonWidth (rearrange this equation)
+	buttonWidth = (mGridWidth - (numberOfOtherButtons + 1) * thickBorder) / numberOfOtherButtons;
 
 	// Carry on from previous starting row
 	buttonStartRow += buttonHeight + thickBorder;
 
 	// Reset starting column
-	int borderWidthTotal = 0;
+	int borderWidthTotal = mLayoutX;
 
 	// Set check, solve, and new buttons (last row)
 	for (int button = 0; button < numberOfOtherButtons; button++) // colBlock is every 3 columns of cells
@@ -271,14 +303,130 @@ void Sudoku::Sudoku::createInterfaceLayout()
 	}
 
 	// Start button 
-	SDL_Rect rect = {(mWindowWidth-200)/2,(mWindowHeight-50)/2,200,50};
+	const int menuButtonWidth = 200 * mGridWidth / mDesignWidth;
+	const int menuButtonHeight = 50 * mGridWidth / mDesignWidth;
+	SDL_Rect rect = { (mWindowWidth - menuButtonWidth) / 2, (mWindowHeight - menuButtonHeight) / 2, menuButtonWidth, menuButtonHeight };
 	mStartButton.setButtonRect(rect);
 	mStartButton.setTexture(mTextureCache[14]);
 
 	// Pause button
-	SDL_Rect rect2 = { (mWindowWidth - 200) / 2, (mWindowHeight - 50) / 2 - 100, 200, 50 };
+	SDL_Rect rect2 = { rect.x, rect.y - 2 * menuButtonHeight, menuButtonWidth, menuButtonHeight };
 	mPauseButton.setButtonRect(rect2);
 	mPauseButton.setTexture(mTextureCache[15]);
+
+	// Pencil marks and given cells need to move with the cells
+	mNotesDirty = true;
+	mGivensDirty = true;
+}
+
+void Sudoku::Sudoku::updateWindowSize()
+{
+	// Get window size in pixels (larger than the window size in points on high-DPI displays)
+	int windowWidth = mDesignWidth;
+	int windowHeight = mDesignHeight;
+	if (SDL_GetRendererOutputSize(mRenderer, &mWindowWidth, &mWindowHeight) != 0)
+	{
+		mWindowWidth = mDesignWidth;
+		mWindowHeight = mDesignHeight;
+	}
+	SDL_GetWindowSize(mWindow, &windowWidth, &windowHeight);
+	Button::setMouseScale(windowWidth > 0 ? (float)mWindowWidth / windowWidth : 1.0f);
+
+	// Fit the design aspect ratio into the window and center it
+	mGridWidth = mWindowWidth;
+	if (mGridWidth * mDesignHeight > mWindowHeight * mDesignWidth)
+	{
+		mGridWidth = mWindowHeight * mDesignWidth / mDesignHeight;
+	}
+	mGridHeight = mGridWidth;
+	mLayoutX = (mWindowWidth - mGridWidth) / 2;
+	mLayoutY = (mWindowHeight - mGridWidth * mDesignHeight / mDesignWidth) / 2;
+
+	// Font scales with the grid
+	mFontSize = mGridHeight / 12;
+}
+
+void Sudoku::Sudoku::handleWindowEvent(const SDL_Event* event)
+{
+	// Render targets lose their contents when the renderer is reset, and the texture itself when the device is lost
+	if (event->type == SDL_RENDER_TARGETS_RESET || event->type == SDL_RENDER_DEVICE_RESET)
+	{
+		if (event->type == SDL_RENDER_DEVICE_RESET && mGivensLayer != nullptr)
+		{
+			SDL_DestroyTexture(mGivensLayer);
+			mGivensLayer = nullptr;
+		}
+		mGivensDirty = true;
+		return;
+	}
+
+	// Open a collection dropped on the window in the browser
+	if (event->type == SDL_DROPFILE)
+	{
+		openCollection(event->drop.file);
+		SDL_free(event->drop.file);
+		return;
+	}
+
+	if (event->type != SDL_WINDOWEVENT)
+	{
+		return;
+	}
+
+	if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED || event->window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED)
+	{
+		// Layout is cheap so recompute it straight away
+		updateWindowSize();
+		createInterfaceLayout();
+
+		// Glyphs are rasterized lazily once the size settles, unless the size is already cached
+		if (mGlyphCache.requestSize(mFontSize, SDL_GetTicks()))
+		{
+			applyTextureCache();
+		}
+	}
+}
+
+bool Sudoku::Sudoku::pollEvent(SDL_Event* event)
+{
+	if (mReplay.getMode() == ReplayMode::REPLAYING)
+	{
+		SDL_Event replayed;
+		while (mReplay.poll(&replayed, SDL_GetTicks(), SDL_GetWindowID(mWindow)))
+		{
+			// Resize the window itself so the renderer output matches, which sends its own size events
+			if (replayed.type == SDL_WINDOWEVENT && (replayed.window.event == SDL_WINDOWEVENT_RESIZED || replayed.window.event == SDL_WINDOWEVENT_SIZE_CHANGED))
+			{
+				SDL_SetWindowSize(mWindow, replayed.window.data1, replayed.window.data2);
+			}
+			else
+			{
+				SDL_PushEvent(&replayed);
+			}
+		}
+	}
+
+	if (SDL_PollEvent(event) == 0)
+	{
+		return false;
+	}
+	mReplay.record(*event, SDL_GetTicks());
+	return true;
+}
+
+void Sudoku::Sudoku::applyTextureCache()
+{
+	mTextureCache = mGlyphCache.getTextures();
+	mFont = mGlyphCache.getFont();
+
+	// Reassign button textures
+	createInterfaceLayout();
+
+	// Reassign cell textures (0 = ' ', 1 to 9 = '1' '2'... '9')
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		mGrid[cell].setTexture(mTextureCache[mBoard.getValue(cell)]);
+	}
 }
 
 void Sudoku::Sudoku::generateSudoku()
@@ -290,51 +438,746 @@ void Sudoku::Sudoku::generateSudoku()
 	int solution[81] = { };
 
 	// Instantiate a Sudoku generator object and generate Sudoku with the empty grids
-	Generator G;
-	G.generate(generatedGrid, solution);
+	const Uint64 generateStart = SDL_GetPerformanceCounter();
+	mSeed = mReplay.getMode() != ReplayMode::OFF ? mReplay.nextSeed() : (unsigned int)(time(NULL) ^ generateStart);
+	mCages = KillerRules();
+	if (mVariant == Variant::DIAGONAL)
+	{
+		DiagonalRules rules;
+		generateVariant(mSeed, generatedGrid, solution, rules);
+	}
+	else if (mVariant == Variant::WINDOKU)
+	{
+		WindokuRules rules;
+		generateVariant(mSeed, generatedGrid, solution, rules);
+	}
+	else if (mVariant == Variant::KILLER)
+	{
+		generateVariant(mSeed, generatedGrid, solution, mCages);
+	}
+	else
+	{
+		Generator G;
+		G.setSeed(mSeed);
+		G.generate(generatedGrid, solution);
+	}
+	mFrameStats.setGenerateTime(generateStart, SDL_GetPerformanceCounter());
 
+	// Givens are the numbers left in the generated grid
+	bool givens[81];
 	for (int i = 0; i < 81; i++)
 	{
-		// Set number and solution
-		mGrid[i].setNumber(generatedGrid[i]);
-		mGrid[i].setSolution(solution[i]); 
+		givens[i] = generatedGrid[i] != 0;
+	}
+	installSudoku(generatedGrid, solution, givens);
+}
+
+void Sudoku::Sudoku::installSudoku(const int* values, const int* solution, const bool* givens)
+{
+	// A new board ends any watched solve
+	mWatching = false;
+
+	// Load numbers, solution and givens into the board model, then update the cells showing it
+	mBoard.load(values, solution, givens);
+	for (int i = 0; i < 81; i++)
+	{
+		mGrid[i].refresh(mTextureCache);
+	}
+	mGivensDirty = true;
+
+	// Start a new edit history from this board
+	mJournal.reset();
+}
+
+void Sudoku::Sudoku::setCellNumber(const int index, const int num)
+{
+	mBoard.setValue(index, num);
+	mGrid[index].setTexture(mTextureCache[num]);
+}
+
+void Sudoku::Sudoku::startWatching()
+{
+	// Solve from the givens with the rules of the variant played
+	int givens[81];
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		givens[cell] = mBoard.isGiven(cell) ? mBoard.getValue(cell) : 0;
+	}
+	VariantRules& rules = mWatchSolver.getRules();
+	rules.variant = mVariant;
+	rules.killer = mCages;
+	if (!mWatchSolver.setGrid(givens))
+	{
+		return;
+	}
+
+	// Keep the player's numbers to give back, then clear them so the solve starts from the givens
+	mBoard.copyValues(mWatchSavedValues);
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		if (!mBoard.isGiven(cell))
+		{
+			setCellNumber(cell, 0);
+		}
+	}
+	mWatching = true;
+}
+
+void Sudoku::Sudoku::stopWatching()
+{
+	if (!mWatching)
+	{
+		return;
+	}
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		if (!mBoard.isGiven(cell))
+		{
+			setCellNumber(cell, mWatchSavedValues[cell]);
+		}
+	}
+	mWatching = false;
+}
+
+void Sudoku::Sudoku::updateWatching()
+{
+	// Show placements and backtracks as they happen
+	const bool finished = mWatchSolver.step(WATCH_NODES_PER_FRAME);
+	const std::vector<StepEvent>& events = mWatchSolver.getEvents();
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		setCellNumber(events[i].cell, events[i].type == StepEvent::PLACE ? events[i].num : 0);
+	}
+	if (!finished)
+	{
+		return;
+	}
+	if (mWatchSolver.getStatus() != SolveStatus::SOLVED)
+	{
+		stopWatching();
+		return;
+	}
+
+	// Journal the change from the player's numbers to the solution as one action, so undo gives them back
+	bool chained = false;
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		const int num = mBoard.getValue(cell);
+		if (!mBoard.isGiven(cell) && num != mWatchSavedValues[cell])
+		{
+			const uint16_t notes = mBoard.getNotes(cell);
+			mJournal.record(cell, mWatchSavedValues[cell], num, notes, notes, SDL_GetTicks(), chained);
+			chained = true;
+		}
+	}
+	mWatching = false;
+}
+
+void Sudoku::Sudoku::eliminateNotes(const int index, const int num)
+{
+	const uint16_t bit = (uint16_t)(1u << (num - 1));
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		const bool peer = Board::getRow(cell) == Board::getRow(index) || Board::getCol(cell) == Board::getCol(index) || Board::getBlock(cell) == Board::getBlock(index);
+		const uint16_t notes = mBoard.getNotes(cell);
+		if (cell != index && peer && (notes & bit))
+		{
+			mJournal.record(cell, mBoard.getValue(cell), mBoard.getValue(cell), notes, notes & ~bit, SDL_GetTicks(), true);
+			mBoard.setNotes(cell, notes & ~bit);
+		}
+	}
+}
+
+void Sudoku::Sudoku::autoFillNotes()
+{
+	bool chained = false;
+	for (int cell = 0; cell < mTotalCells; cell++)
+	{
+		// Candidates come straight from the board's row, col and block masks
+		const uint16_t candidates = mBoard.getCandidates(cell);
+		const uint16_t notes = mBoard.getNotes(cell);
+		if (!mBoard.isGiven(cell) && mBoard.getValue(cell) == 0 && notes != candidates)
+		{
+			// Journal as one action
+			mJournal.record(cell, 0, 0, notes, candidates, SDL_GetTicks(), chained);
+			mBoard.setNotes(cell, candidates);
+			chained = true;
+		}
+	}
+}
+
+bool Sudoku::Sudoku::renderGivens()
+{
+	if (mGivensDirty)
+	{
+		// Size layer to the renderer output
+		int layerWidth = 0;
+		int layerHeight = 0;
+		if (mGivensLayer != nullptr && (SDL_QueryTexture(mGivensLayer, nullptr, nullptr, &layerWidth, &layerHeight) != 0 || layerWidth != mWindowWidth || layerHeight != mWindowHeight))
+		{
+			SDL_DestroyTexture(mGivensLayer);
+			mGivensLayer = nullptr;
+		}
+		if (mGivensLayer == nullptr && SDL_RenderTargetSupported(mRenderer))
+		{
+			mGivensLayer = SDL_CreateTexture(mRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, mWindowWidth, mWindowHeight);
+			SDL_SetTextureBlendMode(mGivensLayer, SDL_BLENDMODE_BLEND);
+		}
+		if (mGivensLayer == nullptr || SDL_SetRenderTarget(mRenderer, mGivensLayer) != 0)
+		{
+			return false;
+		}
+
+		// Borders stay transparent so the clear colour (red or green after a check) still shows through
+		SDL_SetRenderDrawColor(mRenderer, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
+		SDL_RenderClear(mRenderer);
+		for (int cell = 0; cell < mTotalCells; cell++)
+		{
+			if (mBoard.isGiven(cell))
+			{
+				// Repeated givens are drawn red every frame instead, on top of this layer
+				mGrid[cell].Button::renderButton(mRenderer);
+				mGrid[cell].centerTextureRect();
+				mGrid[cell].renderTexture(mRenderer);
+			}
+		}
+		SDL_SetRenderTarget(mRenderer, nullptr);
+		mGivensDirty = false;
+	}
+
+	SDL_RenderCopy(mRenderer, mGivensLayer, nullptr, nullptr);
+	return true;
+}
+
+void Sudoku::Sudoku::renderNotes()
+{
+	SDL_Texture* atlas = mGlyphCache.getAtlas();
+	int atlasWidth;
+	int atlasHeight;
+	mGlyphCache.getAtlasSize(atlasWidth, atlasHeight);
+	if (atlas == nullptr || atlasWidth == 0 || atlasHeight == 0)
+	{
+		return;
+	}
+
+	// Rebuild quads only when pencil marks, numbers, layout or font size changed
+	if (mNotesDirty || mNotesBoardVersion != mBoard.getVersion() || mNotesAtlas != atlas)
+	{
+		mNoteSources.clear();
+		mNoteRects.clear();
 
-		// Set editability
-		if (generatedGrid[i] == 0)
+		for (int cell = 0; cell < mTotalCells; cell++)
 		{
-			// This is a cell that can be editable
-			mGrid[i].setEditable(true);
+			const uint16_t notes = mBoard.getNotes(cell);
+			if (notes == 0 || mBoard.getValue(cell) != 0)
+			{
+				continue;
+			}
+
+			// Each number has its own place in a 3 x 3 sub-grid of the cell
+			const SDL_Rect& cellRect = mGrid[cell].getButtonRect();
+			const float slotWidth = cellRect.w / 3.0f;
+			const float slotHeight = cellRect.h / 3.0f;
+			for (int num = 1; num <= 9; num++)
+			{
+				if (!(notes & (1u << (num - 1))))
+				{
+					continue;
+				}
+
+				// Fit glyph into its slot keeping its aspect ratio
+				const SDL_Rect& source = mGlyphCache.getAtlasRect(num);
+				float scale = slotHeight / source.h;
+				if (source.w * scale > slotWidth)
+				{
+					scale = slotWidth / source.w;
+				}
+				const float width = source.w * scale;
+				const float height = source.h * scale;
+				const float x = cellRect.x + ((num - 1) % 3) * slotWidth + 0.5f * (slotWidth - width);
+				const float y = cellRect.y + ((num - 1) / 3) * slotHeight + 0.5f * (slotHeight - height);
+
+				const SDL_FRect rect = { x, y, width, height };
+				mNoteSources.push_back(source);
+				mNoteRects.push_back(rect);
+			}
 		}
+
+		mNotesBoardVersion = mBoard.getVersion();
+		mNotesAtlas = atlas;
+		mNotesDirty = false;
+	}
+
+	// Up to 9 x 81 = 729 glyphs copied from the one atlas texture, which the renderer batches together
+	for (size_t i = 0; i < mNoteRects.size(); i++)
+	{
+		SDL_RenderCopyF(mRenderer, atlas, &mNoteSources[i], &mNoteRects[i]);
+	}
+}
+
+void Sudoku::Sudoku::renderVariant()
+{
+	if (mVariant == Variant::CLASSIC)
+	{
+		return;
+	}
+	SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_BLEND);
+
+	// Shade cells of the extra regions
+	if (mVariant == Variant::DIAGONAL || mVariant == Variant::WINDOKU)
+	{
+		SDL_SetRenderDrawColor(mRenderer, 90, 140, 230, 70);
+		for (int cell = 0; cell < mTotalCells; cell++)
+		{
+			const bool shaded = mVariant == Variant::DIAGONAL ? DiagonalRules::onDiagonal(cell, 0) || DiagonalRules::onDiagonal(cell, 1) : WindokuRules::getWindow(cell) >= 0;
+			if (shaded)
+			{
+				SDL_RenderFillRect(mRenderer, &mGrid[cell].getButtonRect());
+			}
+		}
+	}
+
+	// Outline cages inside the cells and write each sum in the corner of the cage's first cell
+	if (mVariant == Variant::KILLER)
+	{
+		bool sumDrawn[81] = { };
+		for (int cell = 0; cell < mTotalCells; cell++)
+		{
+			const SDL_Rect& rect = mGrid[cell].getButtonRect();
+			const int inset = rect.w / 12 > 2 ? rect.w / 12 : 2;
+			const int cage = mCages.cageOf[cell];
+			const int row = cell / 9;
+			const int col = cell % 9;
+			const bool up = row > 0 && mCages.cageOf[cell - 9] == cage;
+			const bool down = row < 8 && mCages.cageOf[cell + 9] == cage;
+			const bool left = col > 0 && mCages.cageOf[cell - 1] == cage;
+			const bool right = col < 8 && mCages.cageOf[cell + 1] == cage;
+
+			// Lines run to the edge of the cell where the cage continues
+			const int x0 = left ? rect.x : rect.x + inset;
+			const int x1 = right ? rect.x + rect.w - 1 : rect.x + rect.w - 1 - inset;
+			const int y0 = up ? rect.y : rect.y + inset;
+			const int y1 = down ? rect.y + rect.h - 1 : rect.y + rect.h - 1 - inset;
+			SDL_SetRenderDrawColor(mRenderer, 60, 60, 60, SDL_ALPHA_OPAQUE);
+			if (!up) SDL_RenderDrawLine(mRenderer, x0, y0, x1, y0);
+			if (!down) SDL_RenderDrawLine(mRenderer, x0, y1, x1, y1);
+			if (!left) SDL_RenderDrawLine(mRenderer, x0, y0, x0, y1);
+			if (!right) SDL_RenderDrawLine(mRenderer, x1, y0, x1, y1);
+
+			if (!sumDrawn[cage])
+			{
+				char sum[4];
+				snprintf(sum, sizeof(sum), "%d", mCages.sums[cage]);
+				renderText(sum, rect.x + inset + 1, rect.y + inset + 1, rect.h / 4);
+				sumDrawn[cage] = true;
+			}
+		}
+	}
+
+	SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_NONE);
+}
+
+void Sudoku::Sudoku::saveSnapshot(const time_t elapsed)
+{
+	Snapshot snapshot;
+	snapshot.seed = mSeed;
+	snapshot.elapsedSeconds = (uint32_t)elapsed;
+	for (int i = 0; i < mTotalCells; i++)
+	{
+		snapshot.givens[i] = mBoard.isGiven(i);
+		snapshot.values[i] = (uint8_t)mBoard.getValue(i);
+		snapshot.solution[i] = (uint8_t)mBoard.getSolution(i);
+		snapshot.notes[i] = mBoard.getNotes(i);
+		snapshot.cages[i] = mCages.cageOf[i];
+	}
+	snapshot.variant = (uint8_t)mVariant;
+
+	// Only copies the snapshot, the file is written on the autosave thread
+	mAutosave.submit(snapshot);
+	mSavedBoardVersion = mBoard.getVersion();
+	mSavedElapsed = elapsed;
+}
+
+void Sudoku::Sudoku::restoreSnapshot(const Snapshot& snapshot)
+{
+	int values[81];
+	int solution[81];
+	for (int i = 0; i < 81; i++)
+	{
+		values[i] = snapshot.values[i];
+		solution[i] = snapshot.solution[i];
+	}
+	installSudoku(values, solution, snapshot.givens);
+	for (int i = 0; i < 81; i++)
+	{
+		mBoard.setNotes(i, snapshot.notes[i] & 0x1FF);
+	}
+
+	// Cage sums come from the solution
+	mVariant = snapshot.variant < (int)Variant::TOTAL_VARIANTS ? (Variant)snapshot.variant : Variant::CLASSIC;
+	mCages = KillerRules();
+	if (mVariant == Variant::KILLER)
+	{
+		mCages.setCages(snapshot.cages, solution);
+	}
+
+	mSeed = snapshot.seed;
+	mRestoredElapsed = snapshot.elapsedSeconds;
+	mSavedBoardVersion = mBoard.getVersion();
+	mSavedElapsed = snapshot.elapsedSeconds;
+}
+
+int Sudoku::Sudoku::renderText(const char* text, const int x, const int y, const int height)
+{
+	// Compose text from cached glyphs (digits, '.' and whole words from the texture cache)
+	int penX = x;
+	while (*text != '\0')
+	{
+		int index = -1;
+		int length = 1;
+		if (*text >= '1' && *text <= '9') index = *text - '0';
+		else if (*text == '0') index = 18;
+		else if (*text == '.') index = 19;
+		else if (*text == ' ') index = 0;
 		else
 		{
-			// This cell is fixed and cannot be edited
-			mGrid[i].setEditable(false);
+			// Match the longest cached word (unknown characters are skipped)
+			for (int i = 10; i < mTotalTextures; i++)
+			{
+				if (gTextureStrings[i] == nullptr) continue;
+				const int wordLength = (int)strlen(gTextureStrings[i]);
+				if ((index < 0 || wordLength > length) && strncmp(text, gTextureStrings[i], wordLength) == 0)
+				{
+					index = i;
+					length = wordLength;
+				}
+			}
+		}
+
+		if (index >= 0 && mTextureCache[index] != nullptr)
+		{
+			// Scale glyph to the requested height
+			int textureWidth;
+			int textureHeight;
+			SDL_QueryTexture(mTextureCache[index], NULL, NULL, &textureWidth, &textureHeight);
+			const int width = textureHeight > 0 ? textureWidth * height / textureHeight : 0;
+			SDL_Rect rect = { penX, y, width, height };
+			SDL_RenderCopy(mRenderer, mTextureCache[index], nullptr, &rect);
+			penX += width;
 		}
+		text += length;
+	}
+	return penX - x;
+}
 
-		// Set texture (0 = ' ', 1 to 9 = '1' '2'... '9')
-		mGrid[i].setTexture(mTextureCache[generatedGrid[i]]);
+void Sudoku::Sudoku::renderPerformanceHud()
+{
+	const int rowHeight = mFontSize / 3 > 8 ? mFontSize / 3 : 8;
+	const int labelWidth = 6 * rowHeight;
+	const int columnWidth = 3 * rowHeight;
+	const int left = mLayoutX + rowHeight;
+	const int top = mLayoutY + rowHeight;
+
+	// Translucent white panel behind the text
+	SDL_Rect panel = { left - rowHeight / 2, top - rowHeight / 2, labelWidth + 3 * columnWidth + rowHeight, 7 * rowHeight + rowHeight };
+	SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(mRenderer, 255, 255, 255, 200);
+	SDL_RenderFillRect(mRenderer, &panel);
+	SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_NONE);
+
+	// Header row
+	renderText("ms", left, top, rowHeight);
+	renderText("Min", left + labelWidth, top, rowHeight);
+	renderText("Avg", left + labelWidth + columnWidth, top, rowHeight);
+	renderText("P99", left + labelWidth + 2 * columnWidth, top, rowHeight);
+
+	// One row per frame phase
+	const char* labels[(int)FramePhase::TOTAL_PHASES] = { "Frame", "Events", "Logic", "Render", "Present" };
+	char value[32];
+	for (int phase = 0; phase < (int)FramePhase::TOTAL_PHASES; phase++)
+	{
+		const int rowY = top + (phase + 1) * rowHeight;
+		const PhaseSummary summary = mFrameStats.getSummary((FramePhase)phase);
+		renderText(labels[phase], left, rowY, rowHeight);
+
+		snprintf(value, sizeof(value), "%.2f", summary.min);
+		renderText(value, left + labelWidth, rowY, rowHeight);
+		snprintf(value, sizeof(value), "%.2f", summary.avg);
+		renderText(value, left + labelWidth + columnWidth, rowY, rowHeight);
+		snprintf(value, sizeof(value), "%.2f", summary.p99);
+		renderText(value, left + labelWidth + 2 * columnWidth, rowY, rowHeight);
+	}
 
-		// Center texture onto button
-		mGrid[i].centerTextureRect();
+	// Latency of the last generated Sudoku
+	snprintf(value, sizeof(value), "%.2f", mFrameStats.getGenerateTime());
+	renderText("Generate", left, top + 6 * rowHeight, rowHeight);
+	renderText(value, left + labelWidth, top + 6 * rowHeight, rowHeight);
+}
 
+int64_t Sudoku::Sudoku::handleBrowserEvent(const SDL_Event* event)
+{
+	const size_t count = mCollection.getCount();
+	int64_t move = 0;
+	bool picked = false;
+	if (event->type == SDL_KEYDOWN)
+	{
+		switch (event->key.keysym.sym)
+		{
+		case SDLK_LEFT: move = -1; break;
+		case SDLK_RIGHT: move = 1; break;
+		case SDLK_UP: move = -BROWSE_COLUMNS; break;
+		case SDLK_DOWN: move = BROWSE_COLUMNS; break;
+		case SDLK_PAGEUP: move = -BROWSE_PAGE; break;
+		case SDLK_PAGEDOWN: move = BROWSE_PAGE; break;
+		case SDLK_HOME: move = -(int64_t)mBrowseSelected; break;
+		case SDLK_END: move = (int64_t)count - 1 - (int64_t)mBrowseSelected; break;
+		case SDLK_RETURN: case SDLK_KP_ENTER: picked = true; break;
+		case SDLK_ESCAPE: mBrowsing = false; break;
+		default: break;
+		}
+	}
+	else if (event->type == SDL_MOUSEWHEEL)
+	{
+		// Scroll a row at a time
+		move = -(int64_t)event->wheel.y * BROWSE_COLUMNS;
+	}
+	else if (event->type == SDL_MOUSEBUTTONDOWN && event->button.button == SDL_BUTTON_LEFT)
+	{
+		// Click selects a thumbnail, double click plays it
+		for (int slot = 0; slot < BROWSE_PAGE && mBrowseFirst + slot < count; slot++)
+		{
+			const SDL_Rect rect = getThumbnailRect(slot);
+			if (event->button.x >= rect.x && event->button.x < rect.x + rect.w && event->button.y >= rect.y && event->button.y < rect.y + rect.h)
+			{
+				mBrowseSelected = mBrowseFirst + slot;
+				picked = event->button.clicks >= 2;
+			}
+		}
+	}
+	if (count == 0)
+	{
+		return -1;
 	}
+
+	// Keep the selection on an indexed puzzle, and on the page shown (pages start on a row)
+	int64_t selected = (int64_t)mBrowseSelected + move;
+	selected = selected < 0 ? 0 : (selected >= (int64_t)count ? (int64_t)count - 1 : selected);
+	mBrowseSelected = (size_t)selected;
+	if (mBrowseSelected < mBrowseFirst)
+	{
+		mBrowseFirst = mBrowseSelected - mBrowseSelected % BROWSE_COLUMNS;
+	}
+	else if (mBrowseSelected >= mBrowseFirst + BROWSE_PAGE)
+	{
+		mBrowseFirst = mBrowseSelected - mBrowseSelected % BROWSE_COLUMNS - (BROWSE_ROWS - 1) * BROWSE_COLUMNS;
+	}
+	return picked ? (int64_t)mBrowseSelected : -1;
 }
 
-void Sudoku::Sudoku::freeTextures()
+void Sudoku::Sudoku::loadCollectionPuzzle(const size_t index)
 {
-	for (int i = 0; i < mTotalTextures; i++)
+	int values[81];
+	if (!mCollection.getPuzzle(index, values))
+	{
+		return;
+	}
+
+	// Collections hold classic puzzles; one with no solution is still played, with an unknown (0) solution
+	int solution[81] = { };
+	VariantSolver<ClassicRules> solver;
+	if (!solver.setGrid(values) || !solver.solve(solution))
+	{
+		for (int i = 0; i < 81; i++)
+		{
+			solution[i] = 0;
+		}
+	}
+	bool givens[81];
+	for (int i = 0; i < 81; i++)
 	{
-		// Free texture if it exists
-		if (mTextureCache[i] != nullptr)
+		givens[i] = values[i] != 0;
+	}
+	mVariant = Variant::CLASSIC;
+	mCages = KillerRules();
+	mSeed = 0;
+	installSudoku(values, solution, givens);
+	mBrowsing = false;
+}
+
+SDL_Rect Sudoku::Sudoku::getThumbnailRect(const int slot) const
+{
+	// Browser covers the square grid below the timer, with a status line at the top and a number under each thumbnail
+	const SDL_Rect& timerRect = mTimer.getButtonRect();
+	const int top = timerRect.y + timerRect.h;
+	const int header = mGridWidth / 12;
+	const int slotWidth = mGridWidth / BROWSE_COLUMNS;
+	const int slotHeight = (mGridWidth - header) / BROWSE_ROWS;
+	const int label = slotHeight / 6;
+	const int fit = slotWidth < slotHeight - label ? slotWidth : slotHeight - label;
+
+	// Whole cells so the given squares line up
+	const int side = (fit * 9 / 10) / 9 * 9;
+	SDL_Rect rect;
+	rect.x = mLayoutX + (slot % BROWSE_COLUMNS) * slotWidth + (slotWidth - side) / 2;
+	rect.y = top + header + (slot / BROWSE_COLUMNS) * slotHeight + (slotHeight - label - side) / 2;
+	rect.w = side;
+	rect.h = side;
+	return rect;
+}
+
+void Sudoku::Sudoku::renderBrowser()
+{
+	const SDL_Rect& timerRect = mTimer.getButtonRect();
+	const int top = timerRect.y + timerRect.h;
+	const int header = mGridWidth / 12;
+	const size_t count = mCollection.getCount();
+
+	// Opaque panel over the grid
+	SDL_Rect panel = { mLayoutX, top, mGridWidth, mGridWidth };
+	SDL_SetRenderDrawColor(mRenderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+	SDL_RenderFillRect(mRenderer, &panel);
+
+	// Status line with the selected puzzle and how many there are so far
+	char status[64];
+	snprintf(status, sizeof(status), "Puzzle %llu of %llu", (unsigned long long)(count > 0 ? mBrowseSelected + 1 : 0), (unsigned long long)count);
+	const int textHeight = header / 2;
+	int statusX = mLayoutX + header / 4;
+	statusX += renderText(status, statusX, top + header / 4, textHeight) + header / 4;
+	if (!mCollection.isIndexed())
+	{
+		renderText("Indexing", statusX, top + header / 4, textHeight);
+	}
+
+	// Gather the squares of every given and the outlines of every box of the page, so each is drawn with one call
+	SDL_Rect givens[BROWSE_PAGE * 81];
+	SDL_Rect boxes[BROWSE_PAGE * 9];
+	int totalGivens = 0;
+	int totalBoxes = 0;
+	int selectedSlot = -1;
+	for (int slot = 0; slot < BROWSE_PAGE && mBrowseFirst + slot < count; slot++)
+	{
+		uint8_t cells[81];
+		if (!mCollection.getPuzzle(mBrowseFirst + slot, cells))
+		{
+			continue;
+		}
+		const SDL_Rect rect = getThumbnailRect(slot);
+		const int cellSize = rect.w / 9;
+		for (int cell = 0; cell < 81; cell++)
+		{
+			if (cells[cell] != 0)
+			{
+				const SDL_Rect square = { rect.x + (cell % 9) * cellSize + 1, rect.y + (cell / 9) * cellSize + 1, cellSize - 1, cellSize - 1 };
+				givens[totalGivens++] = square;
+			}
+		}
+		for (int box = 0; box < 9; box++)
 		{
-			SDL_DestroyTexture(mTextureCache[i]);
-			mTextureCache[i] = nullptr;
+			const SDL_Rect outline = { rect.x + (box % 3) * 3 * cellSize, rect.y + (box / 3) * 3 * cellSize, 3 * cellSize + 1, 3 * cellSize + 1 };
+			boxes[totalBoxes++] = outline;
 		}
+		if (mBrowseFirst + slot == mBrowseSelected)
+		{
+			selectedSlot = slot;
+		}
+
+		// Number of the puzzle in the collection
+		char number[24];
+		snprintf(number, sizeof(number), "%llu", (unsigned long long)(mBrowseFirst + slot + 1));
+		renderText(number, rect.x, rect.y + rect.w + rect.w / 24, rect.w / 6);
+	}
+
+	// Highlight the selected thumbnail behind its grid
+	if (selectedSlot >= 0)
+	{
+		const SDL_Rect rect = getThumbnailRect(selectedSlot);
+		const int margin = rect.w / 20 + 1;
+		const SDL_Rect highlight = { rect.x - margin, rect.y - margin, rect.w + 2 * margin, rect.h + 2 * margin };
+		SDL_SetRenderDrawColor(mRenderer, 91, 191, 116, SDL_ALPHA_OPAQUE);
+		SDL_RenderFillRect(mRenderer, &highlight);
+		const SDL_Rect background = { rect.x, rect.y, rect.w + 1, rect.h + 1 };
+		SDL_SetRenderDrawColor(mRenderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+		SDL_RenderFillRect(mRenderer, &background);
+	}
+	SDL_SetRenderDrawColor(mRenderer, 40, 40, 40, SDL_ALPHA_OPAQUE);
+	SDL_RenderFillRects(mRenderer, givens, totalGivens);
+	SDL_SetRenderDrawColor(mRenderer, 160, 160, 160, SDL_ALPHA_OPAQUE);
+	SDL_RenderDrawRects(mRenderer, boxes, totalBoxes);
+}
+
+void Sudoku::Sudoku::freeTextures()
+{
+	// Free menu background if it exists
+	if (mBackgroundTexture != nullptr)
+	{
+		SDL_DestroyTexture(mBackgroundTexture);
+		mBackgroundTexture = nullptr;
 	}
+
+	// Free cached given cells
+	if (mGivensLayer != nullptr)
+	{
+		SDL_DestroyTexture(mGivensLayer);
+		mGivensLayer = nullptr;
+	}
+	mGivensDirty = true;
+
+	// Free glyph textures and fonts
+	mGlyphCache.free();
+	mTextureCache = mGlyphCache.getTextures();
+	mFont = nullptr;
+}
+
+void Sudoku::Sudoku::renderMenu()
+{
+	SDL_RenderCopy(mRenderer, mBackgroundTexture, NULL, NULL);
+	mStartButton.centerTextureRect();
+	mStartButton.renderTexture(mRenderer);
+
+	SDL_RenderPresent(mRenderer);
+}
+
+void Sudoku::Sudoku::recordInput(const std::string& path)
+{
+	mReplay.startRecording(path, (uint32_t)time(NULL));
+}
+
+bool Sudoku::Sudoku::replayInput(const std::string& path)
+{
+	return mReplay.load(path);
+}
+
+void Sudoku::Sudoku::setAudioBufferSize(const int frames)
+{
+	mAudio.setBufferSize(frames);
+}
+
+bool Sudoku::Sudoku::openCollection(const std::string& path)
+{
+	const Uint64 openStart = SDL_GetPerformanceCounter();
+	if (!mCollection.open(path))
+	{
+		std::cerr << "Could not open puzzle collection " << path << std::endl;
+		return false;
+	}
+	std::cout << "Opened " << path << " in " << mFrameStats.toMilliseconds(openStart, SDL_GetPerformanceCounter()) << " ms (indexing in the background)" << std::endl;
+	mBrowsing = true;
+	mCollectionLogged = false;
+	mBrowseSelected = 0;
+	mBrowseFirst = 0;
+	return true;
+}
+
+const Sudoku::InputReplay& Sudoku::Sudoku::getReplay() const
+{
+	return mReplay;
 }
 
 void Sudoku::Sudoku::play()
 {
+	// Measure start up from here
+	const Uint64 startupStart = SDL_GetPerformanceCounter();
+
 	// Initialise SDL
 	if (!initialiseSDL())
 	{
@@ -347,17 +1190,37 @@ void Sudoku::Sudoku::play()
 	// Create interface layout
 	createInterfaceLayout();
 
-	// Generate Sudoku, set textures, and editability of each cell
-	generateSudoku();
+	// Show the menu straight away
+	renderMenu();
+	std::cout << "Time to first frame: " << mFrameStats.toMilliseconds(startupStart, SDL_GetPerformanceCounter()) << " ms" << std::endl;
+
+	// Load music and sound effects in the background, playing the music theme on forever loop once it has loaded
+	mAudio.start(&mAssets, true);
 
-	// Play music theme on forever loop
-	Mix_PlayMusic(music, -1);
+	// Start autosave in the user's preferences folder (recorded and replayed games always start from a new puzzle and aren't saved)
+	if (mReplay.getMode() == ReplayMode::OFF)
+	{
+		char* prefPath = SDL_GetPrefPath("Sudoku_03", "Sudoku");
+		mAutosave.start(std::string(prefPath != nullptr ? prefPath : "") + "autosave.bin");
+		SDL_free(prefPath);
+	}
+
+	// Restore the last game, or generate Sudoku, set textures, and editability of each cell
+	Snapshot savedGame;
+	if (mAutosave.load(savedGame))
+	{
+		restoreSnapshot(savedGame);
+	}
+	else
+	{
+		generateSudoku();
+	}
 
 	// Set first current cell selected
 	Cell* currentCellSelected = &mGrid[0];
 	for (int cell = 0; cell < mTotalCells; cell++)
 	{
-		if (mGrid[cell].isEditable())
+		if (!mBoard.isGiven(cell))
 		{
 			currentCellSelected = &mGrid[cell];
 			currentCellSelected->setSelected(true);
@@ -375,23 +1238,63 @@ void Sudoku::Sudoku::play()
 	bool generateNewSudoku = false;
 	bool checkSolution = false;
 
+	// Puzzle picked in the browser to play next (-1 if none)
+	int64_t pickedPuzzle = -1;
+
 	// Timing for check button
 	bool measureTimeForCheckButton = false;
 	time_t startTimeForCheckButton;
 
+	// Technique shown on the hint button until this time (SDL ticks)
+	int hintTextureIndex = 30;
+	Uint32 hintMessageEnd = 0;
+
+	// Start worker thread for hints
+	mHintEngine.start();
+
+	// Puzzle is ready and input is handled from here (audio and remaining glyphs may still be loading)
+	std::cout << "Time to interactive: " << mFrameStats.toMilliseconds(startupStart, SDL_GetPerformanceCounter()) << " ms" << std::endl;
+	bool audioLogged = false;
+
 	// Timer
 	time_t startTimer;
 	time(&startTimer);
 
+	// Frame timing for the performance overlay
+	Uint64 lastFrameStart = 0;
+
 	// Set default button state
 	mGameState = MENU;
 
+	// Recorded event times are relative to here
+	int windowWidth = 0;
+	int windowHeight = 0;
+	SDL_GetWindowSize(mWindow, &windowWidth, &windowHeight);
+	mReplay.begin(SDL_GetTicks(), windowWidth, windowHeight);
+
 	while(mGameState != EXIT) {
-		while (SDL_PollEvent(&event)) {
+		// Rasterize glyphs once the window size has settled
+		if (mGlyphCache.update(SDL_GetTicks()))
+		{
+			applyTextureCache();
+		}
+
+		// Report when background loading has finished
+		if (!audioLogged && mAudio.isReady())
+		{
+			std::cout << "Audio loaded in " << mAudio.getLoadTime() << " ms (" << mFrameStats.toMilliseconds(startupStart, SDL_GetPerformanceCounter()) << " ms after start, "
+				<< mAudio.getBufferSize() << " frame buffer)" << std::endl;
+			audioLogged = true;
+		}
+
+		while (pollEvent(&event)) {
 
 			// Handle quiting
 			if (event.type == SDL_QUIT) mGameState = EXIT;
 
+			// Handle resizing
+			handleWindowEvent(&event);
+
 			//Handle EXIT state
 			if (mGameState == EXIT) {
 				stop = true;
@@ -403,16 +1306,12 @@ void Sudoku::Sudoku::play()
 				if (mStartButton.getMouseEvent(&event) == ButtonState::BUTTON_MOUSE_DOWN) {
 					mGameState = PLAYING;
 
-					// Start time
+					// Start time (continuing from a restored game)
 					time(&startTimer);
+					startTimer -= mRestoredElapsed;
+					mRestoredElapsed = 0;
 				}
-				SDL_RenderCopy(mRenderer, mTextureCache[16], NULL, NULL);
-				mStartButton.centerTextureRect();
-				mStartButton.renderTexture(mRenderer);
-
-				SDL_RenderPresent(mRenderer);
-
-
+				renderMenu();
 			}
 			// Handle PAUSED state
 			if (mGameState == PAUSED) {
@@ -425,7 +1324,7 @@ void Sudoku::Sudoku::play()
 					mGameState = PLAYING;
 					stop = false;
 				}
-				SDL_RenderCopy(mRenderer, mTextureCache[16], NULL, NULL);
+				SDL_RenderCopy(mRenderer, mBackgroundTexture, NULL, NULL);
 
 				// Render start button
 				mStartButton.centerTextureRect();
@@ -444,8 +1343,16 @@ void Sudoku::Sudoku::play()
 				// Game loop
 				while (!stop)
 				{
+					// Time whole frame from the start of the previous one
+					const Uint64 frameStart = SDL_GetPerformanceCounter();
+					if (lastFrameStart != 0)
+					{
+						mFrameStats.record(FramePhase::FRAME, lastFrameStart, frameStart);
+					}
+					lastFrameStart = frameStart;
+
 					// Handle events on queue
-					while (SDL_PollEvent(&event) != 0)
+					while (pollEvent(&event))
 					{
 						// Handle quiting and completion
 						if (event.type == SDL_QUIT)
@@ -457,6 +1364,28 @@ void Sudoku::Sudoku::play()
 							mGameState = EXIT;
 
 						}
+						// Handle resizing
+						handleWindowEvent(&event);
+
+						// Toggle performance overlay
+						if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F1)
+						{
+							mShowPerformanceHud = !mShowPerformanceHud;
+						}
+
+						// Toggle the puzzle browser, which takes every other event while it is shown
+						if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_b && mCollection.isOpen())
+						{
+							mBrowsing = !mBrowsing;
+							continue;
+						}
+						if (mBrowsing)
+						{
+							const int64_t picked = handleBrowserEvent(&event);
+							pickedPuzzle = picked >= 0 ? picked : pickedPuzzle;
+							continue;
+						}
+
 						// Handle mouse event for "Check" button
 						if (mCheckButton.getMouseEvent(&event) == ButtonState::BUTTON_MOUSE_DOWN)
 						{
@@ -471,7 +1400,17 @@ void Sudoku::Sudoku::play()
 							generateNewSudoku = true;
 
 							// Play new level effect
-							Mix_PlayChannel(-1, newLevelEffect, 0);
+							mAudio.play(SoundEffect::NEW_GAME, frameStart);
+						}
+						// Handle mouse event for "Hint" button
+						if (mHintButton.getMouseEvent(&event) == ButtonState::BUTTON_MOUSE_DOWN)
+						{
+							// Ask the worker thread for the next placement on the current board
+							int grid[81];
+							mBoard.copyValues(grid);
+							mHintEngine.request(grid);
+							mHintBoardVersion = mBoard.getVersion();
+							mHintPending = true;
 						}
 						// Handle mouse event for "Pause" button
 						if (mPauseGameButton.getMouseEvent(&event) == ButtonState::BUTTON_MOUSE_DOWN)
@@ -484,7 +1423,7 @@ void Sudoku::Sudoku::play()
 						for (int cell = 0; cell < mTotalCells; cell++)
 						{
 							// If editable
-							if (mGrid[cell].isEditable())
+							if (!mBoard.isGiven(cell))
 							{
 								// Set button state and return if mouse pressed on cell
 								if (mGrid[cell].getMouseEvent(&event) == ButtonState::BUTTON_MOUSE_DOWN)
@@ -497,18 +1436,131 @@ void Sudoku::Sudoku::play()
 									currentCellSelected->setSelected(true);
 
 									// Play sound effect
-									Mix_PlayChannel(-1, soundEffect, 0);
+									mAudio.play(SoundEffect::CLICK, frameStart);
+								}
+							}
+						}
+						// Any key other than W stops a watched solve and gives the board back to the player
+						if (mWatching && event.type == SDL_KEYDOWN && event.key.keysym.sym != SDLK_w && event.key.keysym.sym != SDLK_F1)
+						{
+							stopWatching();
+						}
+
+						// Handle undo and redo (chained records are undone and redone as one action)
+						JournalRecord record;
+						if (event.type == SDL_KEYDOWN && (event.key.keysym.mod & KMOD_CTRL))
+						{
+							const bool shift = (event.key.keysym.mod & KMOD_SHIFT) != 0;
+							int changedIndex = -1;
+							if (event.key.keysym.sym == SDLK_z && !shift)
+							{
+								while (mJournal.undo(record))
+								{
+									setCellNumber(record.index, record.oldValue);
+									mBoard.setNotes(record.index, record.oldNotes);
+									changedIndex = record.index;
+									if (!(record.flags & JournalRecord::CHAINED)) break;
+								}
+							}
+							else if (event.key.keysym.sym == SDLK_y || (event.key.keysym.sym == SDLK_z && shift))
+							{
+								while (mJournal.redo(record))
+								{
+									setCellNumber(record.index, record.newValue);
+									mBoard.setNotes(record.index, record.newNotes);
+									changedIndex = changedIndex < 0 ? record.index : changedIndex;
+									if (!mJournal.isRedoChained()) break;
+								}
+							}
+
+							// Select the cell the action started from
+							if (changedIndex >= 0)
+							{
+								currentCellSelected->setSelected(false);
+								currentCellSelected = &mGrid[changedIndex];
+								currentCellSelected->setSelected(true);
+							}
+						}
+						else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_v)
+						{
+							// Start a new game of the next variant
+							mVariant = (Variant)(((int)mVariant + 1) % (int)Variant::TOTAL_VARIANTS);
+							generateNewSudoku = true;
+						}
+						else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_n)
+						{
+							// Toggle pencil mark mode
+							mNotesMode = !mNotesMode;
+						}
+						else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_a)
+						{
+							// Fill in all candidates
+							autoFillNotes();
+						}
+						else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_w)
+						{
+							// Toggle watching the solver fill the grid
+							if (mWatching)
+							{
+								stopWatching();
+							}
+							else
+							{
+								startWatching();
+							}
+						}
+
+						const int selectedIndex = currentCellSelected->getIndex();
+						const int typedNumber = event.type == SDL_TEXTINPUT ? event.text.text[0] - '0' : 0;
+						if (mNotesMode && typedNumber >= 1 && typedNumber <= 9)
+						{
+							// Toggle pencil mark of an empty editable cell
+							if (!mBoard.isGiven(selectedIndex) && mBoard.getValue(selectedIndex) == 0)
+							{
+								const uint16_t notes = mBoard.getNotes(selectedIndex);
+								const uint16_t newNotes = notes ^ (uint16_t)(1u << (typedNumber - 1));
+								mJournal.record(selectedIndex, 0, 0, notes, newNotes, SDL_GetTicks());
+								mBoard.setNotes(selectedIndex, newNotes);
+							}
+						}
+						else
+						{
+							// Handle keyboard events for current cell selected, journalling any change
+							const int previousNumber = mBoard.getValue(selectedIndex);
+							currentCellSelected->handleKeyboardEvent(&event, mTextureCache);
+							const int newNumber = mBoard.getValue(selectedIndex);
+							if (newNumber != previousNumber)
+							{
+								const uint16_t notes = mBoard.getNotes(selectedIndex);
+								mJournal.record(selectedIndex, previousNumber, newNumber, notes, notes, SDL_GetTicks());
+								if (newNumber != 0)
+								{
+									eliminateNotes(selectedIndex, newNumber);
 								}
 							}
 						}
-						// Handle keyboard events for current cell selected
-						currentCellSelected->handleKeyboardEvent(&event, mTextureCache);
 					}
-					// If "New" button was clicked
-					if (generateNewSudoku)
+					const Uint64 eventsEnd = SDL_GetPerformanceCounter();
+					mFrameStats.record(FramePhase::EVENTS, frameStart, eventsEnd);
+
+					// Rasterize glyphs once the window size has settled
+					if (mGlyphCache.update(SDL_GetTicks()))
 					{
-						// Generate new sudoku
-						generateSudoku();
+						applyTextureCache();
+					}
+
+					// If "New" button was clicked or a puzzle was picked in the browser
+					if (generateNewSudoku || pickedPuzzle >= 0)
+					{
+						// Generate new sudoku, or load the puzzle picked
+						if (pickedPuzzle >= 0)
+						{
+							loadCollectionPuzzle((size_t)pickedPuzzle);
+						}
+						else
+						{
+							generateSudoku();
+						}
 
 						// Set current cell selected to false
 						currentCellSelected->setSelected(false);
@@ -516,7 +1568,7 @@ void Sudoku::Sudoku::play()
 						// Find new starting cell
 						for (int cell = 0; cell < mTotalCells; cell++)
 						{
-							if (mGrid[cell].isEditable())
+							if (!mBoard.isGiven(cell))
 							{
 								currentCellSelected = &mGrid[cell];
 								currentCellSelected->setSelected(true);
@@ -526,28 +1578,82 @@ void Sudoku::Sudoku::play()
 
 						// Reset flags
 						generateNewSudoku = false;
+						pickedPuzzle = -1;
 						completed = false;
 
 						// Reset timer
 						time(&startTimer);
 					}
 
+					// Advance a watched solve
+					if (mWatching)
+					{
+						updateWatching();
+					}
+
+					// Report once the browsed collection has been indexed
+					if (!mCollectionLogged && mCollection.isIndexed())
+					{
+						std::cout << "Indexed " << mCollection.getCount() << " puzzles of " << mCollection.getPath() << " in " << mCollection.getIndexTime() << " ms" << std::endl;
+						mCollectionLogged = true;
+					}
+
+					// Autosave when the board changes and every 10 seconds for the timer (writes are coalesced in the background, and not while a solve is watched)
+					const time_t elapsed = time(NULL) - startTimer;
+					if (!mWatching && (mBoard.getVersion() != mSavedBoardVersion || elapsed - mSavedElapsed >= 10))
+					{
+						saveSnapshot(elapsed);
+					}
+
+					// Drop hint request if the board changed since it was made
+					if (mHintPending && mBoard.getVersion() != mHintBoardVersion)
+					{
+						mHintEngine.cancel();
+						mHintPending = false;
+					}
+
+					// Place finished hint (polled without blocking, so it shows on the frame it arrives)
+					Hint hint;
+					if (mHintPending && mHintEngine.poll(hint))
+					{
+						mHintPending = false;
+						if (hint.index >= 0)
+						{
+							// Fill in the number and select the cell
+							const uint16_t notes = mBoard.getNotes(hint.index);
+							mJournal.record(hint.index, mBoard.getValue(hint.index), hint.num, notes, notes, SDL_GetTicks());
+							setCellNumber(hint.index, hint.num);
+							eliminateNotes(hint.index, hint.num);
+							currentCellSelected->setSelected(false);
+							currentCellSelected = &mGrid[hint.index];
+							currentCellSelected->setSelected(true);
+							mAudio.play(SoundEffect::CLICK, frameStart);
+						}
+
+						// Show technique on the hint button for 2 seconds
+						hintTextureIndex = 30 + (int)hint.technique;
+						if (hint.technique == HintTechnique::NONE)
+						{
+							hintTextureIndex = 35;
+						}
+						hintMessageEnd = SDL_GetTicks() + 2000;
+					}
+					mHintButton.setTexture(mTextureCache[SDL_GetTicks() < hintMessageEnd ? hintTextureIndex : 30]);
+
 					// If "Check" button was clicked
 					if (checkSolution)
 					{
-						// Check if complete
-						for (int cell = 0; cell < mTotalCells; cell++)
+						// Check if complete (full with no repeated numbers, known without scanning the cells)
+						completed = mBoard.isSolved();
+
+						// Variants have constraints the board doesn't count, so compare with the solution
+						for (int cell = 0; cell < mTotalCells && completed && mVariant != Variant::CLASSIC; cell++)
 						{
-							if (!mGrid[cell].isCorrect())
-							{
-								completed = false;
-								break;
-							}
-							completed = true;
+							completed = mBoard.getSolution(cell) == 0 || mBoard.getValue(cell) == mBoard.getSolution(cell);
 						}
 
 						for (int cell = 0;cell < mTotalCells;cell++) {
-							if (mGrid[cell].isEditable()) {
+							if (!mBoard.isGiven(cell)) {
 								mGrid[cell].setCorrect();
 							}
 						}
@@ -558,11 +1664,11 @@ void Sudoku::Sudoku::play()
 
 						// if you win
 						if (completed) {
-							Mix_PlayChannel(-1, winSoundEffect, 0);
+							mAudio.play(SoundEffect::WIN, frameStart);
 						}
 						else {
 							// Play check sound
-							Mix_PlayChannel(-1, checkSolutionSoundEffect, 0);
+							mAudio.play(SoundEffect::CHECK_SOLUTION, frameStart);
 						}
 
 						// Reset flag
@@ -616,12 +1722,23 @@ void Sudoku::Sudoku::play()
 						SDL_SetRenderDrawColor(mRenderer, mClearColour.r, mClearColour.g, mClearColour.b, mClearColour.a);
 					}
 
+					const Uint64 logicEnd = SDL_GetPerformanceCounter();
+					mFrameStats.record(FramePhase::LOGIC, eventsEnd, logicEnd);
+
 					// Clear screen with rendered colour
 					SDL_RenderClear(mRenderer);
 
-					// Render buttons and texture of each cell to backbuffer
+					// Copy given cells from their cached layer
+					const bool givensCached = renderGivens();
+
+					// Render buttons and texture of each cell to backbuffer (givens only when they aren't cached or are shown as repeated)
 					for (int cell = 0; cell < mTotalCells; cell++)
 					{
+						if (givensCached && mBoard.isGiven(cell) && !mBoard.isConflict(cell))
+						{
+							continue;
+						}
+
 						// Render button
 						mGrid[cell].renderButton(mRenderer);
 
@@ -632,6 +1749,10 @@ void Sudoku::Sudoku::play()
 						mGrid[cell].renderTexture(mRenderer);
 					}
 
+					// Render variant regions and pencil marks on top of the cells
+					renderVariant();
+					renderNotes();
+
 					// Render check button
 					mCheckButton.renderButton(mRenderer);
 					mCheckButton.centerTextureRect();
@@ -642,6 +1763,11 @@ void Sudoku::Sudoku::play()
 					mNewButton.centerTextureRect();
 					mNewButton.renderTexture(mRenderer);
 
+					// Render hint button
+					mHintButton.renderButton(mRenderer);
+					mHintButton.centerTextureRect();
+					mHintButton.renderTexture(mRenderer);
+
 					// Render pause button
 					mPauseGameButton.renderButton(mRenderer);
 					mPauseGameButton.centerTextureRect();
@@ -665,8 +1791,37 @@ void Sudoku::Sudoku::play()
 					SDL_DestroyTexture(timerTexture);
 					timerTexture = nullptr;
 
+					// Show the variant and that typed numbers are pencil marks
+					const SDL_Rect& timerRect = mTimer.getButtonRect();
+					int labelX = timerRect.x + timerRect.h / 4;
+					if (gVariantNames[(int)mVariant] != nullptr)
+					{
+						labelX += renderText(gVariantNames[(int)mVariant], labelX, timerRect.y + timerRect.h / 4, timerRect.h / 2) + timerRect.h / 4;
+					}
+					if (mNotesMode)
+					{
+						renderText("Notes", labelX, timerRect.y + timerRect.h / 4, timerRect.h / 2);
+					}
+
+					// Render puzzle browser over the grid
+					if (mBrowsing)
+					{
+						renderBrowser();
+					}
+
+					// Render performance overlay
+					if (mShowPerformanceHud)
+					{
+						renderPerformanceHud();
+					}
+					const Uint64 renderEnd = SDL_GetPerformanceCounter();
+					mFrameStats.record(FramePhase::RENDER, logicEnd, renderEnd);
+
 					// Update screen from backbuffer and clear backbuffer
 					SDL_RenderPresent(mRenderer);
+					mFrameStats.record(FramePhase::PRESENT, renderEnd, SDL_GetPerformanceCounter());
+					mFrameStats.commitFrame();
+					mReplay.recordFrame(mFrameStats);
 
 					// Slow down program becuase it doesn't need to run very fast
 					SDL_Delay(10);
@@ -680,6 +1835,19 @@ void Sudoku::Sudoku::play()
 	// Disable text input
 	SDL_StopTextInput();
 
+	// Stop hint worker thread
+	mHintEngine.stop();
+
+	// Save final state and wait for the autosave thread to write it
+	if (mRestoredElapsed == 0)
+	{
+		saveSnapshot(time(NULL) - startTimer);
+	}
+	mAutosave.stop();
+
+	// Write recorded input
+	mReplay.finish();
+
 	// Free button textures
 	freeTextures();
 
@@ -689,16 +1857,30 @@ void Sudoku::Sudoku::play()
 
 void Sudoku::Sudoku::close()
 {
+	// Free fonts and glyph textures (owned by the glyph cache) while the renderer still exists
+	mGlyphCache.free();
+	mTextureCache = mGlyphCache.getTextures();
+	mFont = nullptr;
+
+	// Report input to sound latency of the effects played, then wait for the audio loader and close the audio device
+	if (mAudio.getLatencyCount() > 0)
+	{
+		const PhaseSummary latency = mAudio.getLatencySummary();
+		char line[160];
+		snprintf(line, sizeof(line), "Input to sound latency of %d effects: min %.1f  avg %.1f  p99 %.1f  max %.1f ms", mAudio.getLatencyCount(), latency.min, latency.avg, latency.p99, latency.max);
+		std::cout << line << std::endl;
+	}
+	mAudio.stop();
+
+	// Unmap assets once nothing reads from them
+	mAssets.close();
+
 	// Destroy
 	SDL_DestroyRenderer(mRenderer);
 	SDL_DestroyWindow(mWindow);
 	mRenderer = nullptr;
 	mWindow = nullptr;
 
-	// Free font
-	TTF_CloseFont(mFont);
-	mFont = nullptr;
-
 	// Quit
 	SDL_Quit();
 	TTF_Quit();
@@ -3,25 +3,44 @@
 #include <SDL.h> 
 #include <iostream>
 #include <time.h>  
-#include <SDL_mixer.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
 
 #include "Button.h"
 #include "SudokuCell.h"
 #include "SudokuGenerator.h"
 #include "GameState.h"
+#include "SudokuGlyphCache.h"
+#include "SudokuFrameStats.h"
+#include "SudokuHintEngine.h"
+#include "SudokuAutosave.h"
+#include "SudokuJournal.h"
+#include "SudokuAudio.h"
+#include "SudokuAssetArchive.h"
+#include "SudokuVariantSolver.h"
+#include "SudokuStepSolver.h"
+#include "SudokuInputReplay.h"
+#include "SudokuPuzzleCollection.h"
 
 namespace Sudoku
 {
 	class Sudoku
 	{
 	private:
-		// Define window dimensions
-		const int mWindowHeight;
-		const int mWindowWidth;
+		// Define design dimensions the layout is scaled from
+		const int mDesignHeight;
+		const int mDesignWidth;
 
-		// Define Sudoku grid dimensions
-		const int mGridHeight;
-		const int mGridWidth;
+		// Define window dimensions (in renderer pixels, updated on resize)
+		int mWindowHeight;
+		int mWindowWidth;
+
+		// Define Sudoku grid dimensions and top left corner of the scaled layout
+		int mGridHeight;
+		int mGridWidth;
+		int mLayoutX;
+		int mLayoutY;
 
 		// Define Sudoku max grid rows and columns (normally set to 9 x 9)
 		const int mGridRows;
@@ -31,9 +50,16 @@ namespace Sudoku
 		SDL_Window* mWindow;
 		SDL_Renderer* mRenderer;
 
-		// Texture cache to hold preloaded textures
+		// Memory-mapped asset archive (loose files in the assets folder are used for anything not packed)
+		AssetArchive mAssets;
+
+		// Texture cache to hold preloaded textures (points into the glyph cache's active font size)
 		int mTotalTextures;
-		SDL_Texture* mTextureCache[20];
+		SDL_Texture** mTextureCache;
+		GlyphCache mGlyphCache;
+
+		// Menu background texture
+		SDL_Texture* mBackgroundTexture;
 
 		// Define true type font paramaters
 		TTF_Font* mFont;
@@ -45,12 +71,51 @@ namespace Sudoku
 		// Define grid of cells (normally set to 9 x 9 = 81)
 		Cell mGrid[81];
 
+		// Board model with row, col and block digit counts kept up to date by the cells
+		Board mBoard;
+
+		// Journal of edits for undo (Ctrl+Z) and redo (Ctrl+Y or Ctrl+Shift+Z)
+		Journal mJournal;
+
+		// Variant played (cycled with V, starting a new game) and the killer cages of the current puzzle
+		Variant mVariant;
+		KillerRules mCages;
+
+		// Typed numbers toggle pencil marks instead of filling cells (toggled with N, A fills in all candidates)
+		bool mNotesMode;
+
+		// Atlas rect and screen rect of every pencil mark, rebuilt when the board or layout changes
+		std::vector<SDL_Rect> mNoteSources;
+		std::vector<SDL_FRect> mNoteRects;
+		unsigned int mNotesBoardVersion;
+		SDL_Texture* mNotesAtlas;
+		bool mNotesDirty;
+
+		// Given cells and their numbers drawn once into a render target and copied every frame (redrawn when the puzzle, layout, glyphs or renderer change)
+		SDL_Texture* mGivensLayer;
+		bool mGivensDirty;
+
+		// Watch-it-solve mode (toggled with W): the solver fills the grid from the givens a few placements per frame
+		StepSolver<VariantRules> mWatchSolver;
+		bool mWatching;
+		int mWatchSavedValues[81];
+
+		// Frame timing statistics and performance overlay visibility (toggled with F1)
+		FrameStats mFrameStats;
+		bool mShowPerformanceHud;
+
 		// Define check and new buttons
 		Button mCheckButton;
 		Button mNewButton;
 		Button mStartButton;
 		Button mPauseButton;
 		Button mPauseGameButton;
+		Button mHintButton;
+
+		// Hint engine running on a worker thread and the board version its request was made for
+		HintEngine mHintEngine;
+		unsigned int mHintBoardVersion;
+		bool mHintPending;
 
 
 		// Timer
@@ -59,16 +124,35 @@ namespace Sudoku
 		// Define colours 
 		SDL_Color mClearColour;
 
-		// Sound effect and music
-		Mix_Chunk* soundEffect;
-		Mix_Music* music;
-		Mix_Chunk* newLevelEffect;
-		Mix_Chunk* winSoundEffect;
-		Mix_Chunk* checkSolutionSoundEffect;
+		// Sound effects and music (loaded in the background after the first frame is shown)
+		Audio mAudio;
 
 		// Define game state
 		Gamestate mGameState;
 
+		// Seed of the current puzzle
+		unsigned int mSeed;
+
+		// Autosave and what was last saved
+		Autosave mAutosave;
+		unsigned int mSavedBoardVersion;
+		time_t mSavedElapsed;
+
+		// Seconds already played in a restored game (added to the timer when play starts)
+		time_t mRestoredElapsed;
+
+		// Input recorded to a file or replayed from one (neither restores nor autosaves games)
+		InputReplay mReplay;
+
+		// Puzzle collection (opened with --browse or by dropping a file on the window) and whether its browser is shown over the grid (toggled with B)
+		PuzzleCollection mCollection;
+		bool mBrowsing;
+		bool mCollectionLogged;
+
+		// Selected puzzle of the browser and the first puzzle of the page shown
+		size_t mBrowseSelected;
+		size_t mBrowseFirst;
+
 	private:
 		// Intialise SDL window, renderer and true type font
 		bool initialiseSDL();
@@ -84,13 +168,78 @@ namespace Sudoku
 
 		// Create interface layout by setting button parameters
 		void createInterfaceLayout();
+
+		// Recompute window, grid and font size from the renderer output size
+		void updateWindowSize();
+
+		// Handle window resize, display change, render target reset and file drop events
+		void handleWindowEvent(const SDL_Event* event);
+
+		// Poll next event, queueing replayed events that are due first and recording polled events when recording
+		bool pollEvent(SDL_Event* event);
+
+		// Switch to the glyph cache's active textures and reassign them to every button
+		void applyTextureCache();
 		
 		// Generate a Sudoku puzzle with a unique solution
 		void generateSudoku();
 
+		// Set numbers, solution (may be all 0) and editability of every cell (givens are fixed cells)
+		void installSudoku(const int* values, const int* solution, const bool* givens);
+
+		// Set number and texture of a cell without journalling it
+		void setCellNumber(const int index, const int num);
+
+		// Remove a placed number from the pencil marks of the cells in its row, col and block (journalled as part of the placement)
+		void eliminateNotes(const int index, const int num);
+
+		// Set pencil marks of every empty cell to the numbers not yet in its row, col and block
+		void autoFillNotes();
+
+		// Start solving the puzzle on screen from its givens, or stop and give the player's numbers back
+		void startWatching();
+		void stopWatching();
+
+		// Show the next placements of the watched solve, journalling the whole solve as one action once it is solved
+		void updateWatching();
+
+		// Render given cells from the cached layer, redrawing it first if out of date (returns false if render targets aren't available)
+		bool renderGivens();
+
+		// Render pencil marks of every empty cell with one draw call from the small digit atlas
+		void renderNotes();
+
+		// Render extra regions of the variant (diagonals, windows, or killer cages and their sums)
+		void renderVariant();
+
+		// Save current game in the background and restore a saved game
+		void saveSnapshot(const time_t elapsed);
+		void restoreSnapshot(const Snapshot& snapshot);
+
 		// Free textures
 		void freeTextures();
 
+		// Render text composed from cached glyphs scaled to a height and return its width
+		int renderText(const char* text, const int x, const int y, const int height);
+
+		// Render performance overlay with per-phase frame timing
+		void renderPerformanceHud();
+
+		// Handle keys and mouse in the browser, returning the puzzle picked to play (-1 if none)
+		int64_t handleBrowserEvent(const SDL_Event* event);
+
+		// Play a puzzle of the collection, solving it for the solution (classic rules)
+		void loadCollectionPuzzle(const size_t index);
+
+		// Get rect of the thumbnail in a slot of the browser page
+		SDL_Rect getThumbnailRect(const int slot) const;
+
+		// Render the page of thumbnails holding the selected puzzle over the grid (only the puzzles on the page are read)
+		void renderBrowser();
+
+		// Render menu background and start button and present them
+		void renderMenu();
+
 
 	public:
 		// Constructor to intialise member variables
@@ -100,6 +249,19 @@ namespace Sudoku
 		~Sudoku();
 
 	public:
+		// Record input of the next play to a file, or replay a recording headlessly with the software renderer (call before play)
+		void recordInput(const std::string& path);
+		bool replayInput(const std::string& path);
+
+		// Get input recorder (holds the frame timings of a replay once play returns)
+		const InputReplay& getReplay() const;
+
+		// Open a puzzle collection and show its browser (indexing continues in the background, so the first page shows straight away)
+		bool openCollection(const std::string& path);
+
+		// Set audio device buffer size in sample frames (call before play; Audio::DEFAULT_BUFFER trades latency for fewer dropouts)
+		void setAudioBufferSize(const int frames);
+
 		// Play Sudoku
 		void play();
 
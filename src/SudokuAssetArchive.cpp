@@ -0,0 +1,271 @@
+#include "SudokuAssetArchive.h"
+#include "SudokuPlatform.h"
+#include <iostream>
+#include <string.h>
+
+namespace
+{
+	// File magic and format version
+	const uint8_t ARCHIVE_MAGIC[4] = { 'S', 'D', 'K', 'A' };
+	const uint32_t ARCHIVE_VERSION = 1;
+
+	// Little-endian integers
+	void writeU16(uint8_t* bytes, const uint16_t value)
+	{
+		bytes[0] = (uint8_t)value;
+		bytes[1] = (uint8_t)(value >> 8);
+	}
+
+	void writeU32(uint8_t* bytes, const uint32_t value)
+	{
+		bytes[0] = (uint8_t)value;
+		bytes[1] = (uint8_t)(value >> 8);
+		bytes[2] = (uint8_t)(value >> 16);
+		bytes[3] = (uint8_t)(value >> 24);
+	}
+
+	uint16_t readU16(const uint8_t* bytes)
+	{
+		return (uint16_t)(bytes[0] | (bytes[1] << 8));
+	}
+
+	uint32_t readU32(const uint8_t* bytes)
+	{
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+
+	// Check if a file name ends with an extension
+	bool hasExtension(const std::string& name, const char* extension)
+	{
+		const size_t length = strlen(extension);
+		return name.size() >= length && name.compare(name.size() - length, length, extension) == 0;
+	}
+
+	// Read a whole file into memory
+	bool readFile(const std::string& path, std::vector<uint8_t>& bytes)
+	{
+		FILE* file = Sudoku::openFile(path.c_str(), "rb");
+		if (file == nullptr)
+		{
+			return false;
+		}
+		bytes.clear();
+		uint8_t buffer[4096];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			bytes.insert(bytes.end(), buffer, buffer + read);
+		}
+		fclose(file);
+		return true;
+	}
+
+	// Decode a WAV file and convert it to an audio format
+	bool decodeWav(const std::string& path, const int frequency, const uint16_t format, const int channels, std::vector<uint8_t>& bytes)
+	{
+		SDL_AudioSpec spec;
+		Uint8* samples = nullptr;
+		Uint32 length = 0;
+		if (SDL_LoadWAV(path.c_str(), &spec, &samples, &length) == nullptr)
+		{
+			std::cout << "Could not decode " << path << "! Error: " << SDL_GetError() << std::endl;
+			return false;
+		}
+
+		SDL_AudioCVT converter;
+		if (SDL_BuildAudioCVT(&converter, spec.format, spec.channels, spec.freq, format, (Uint8)channels, frequency) < 0)
+		{
+			std::cout << "Could not convert " << path << "! Error: " << SDL_GetError() << std::endl;
+			SDL_FreeWAV(samples);
+			return false;
+		}
+
+		// Convert in place in a buffer big enough for the conversion
+		converter.len = (int)length;
+		bytes.assign((size_t)length * (converter.len_mult > 0 ? converter.len_mult : 1), 0);
+		memcpy(bytes.data(), samples, length);
+		SDL_FreeWAV(samples);
+		converter.buf = bytes.data();
+		if (converter.needed && SDL_ConvertAudio(&converter) < 0)
+		{
+			std::cout << "Could not convert " << path << "! Error: " << SDL_GetError() << std::endl;
+			return false;
+		}
+		bytes.resize(converter.needed ? (size_t)converter.len_cvt : (size_t)length);
+		return true;
+	}
+}
+
+Sudoku::AssetArchive::AssetArchive()
+	: mData(nullptr), mSize(0)
+{
+
+}
+
+Sudoku::AssetArchive::~AssetArchive()
+{
+	close();
+}
+
+bool Sudoku::AssetArchive::open(const std::string& path)
+{
+	close();
+
+	mData = mapFile(path.c_str(), mSize);
+	if (mData == nullptr)
+	{
+		return false;
+	}
+
+	// Check header
+	bool valid = mSize >= (size_t)HEADER_SIZE && memcmp(mData, ARCHIVE_MAGIC, 4) == 0 && readU32(mData + 4) == ARCHIVE_VERSION;
+	const uint32_t totalEntries = valid ? readU32(mData + 8) : 0;
+	valid = valid && (size_t)HEADER_SIZE + (size_t)totalEntries * ENTRY_SIZE <= mSize;
+
+	// Read index, rejecting entries that point outside the file
+	for (uint32_t i = 0; valid && i < totalEntries; i++)
+	{
+		const uint8_t* bytes = mData + HEADER_SIZE + i * ENTRY_SIZE;
+		AssetEntry entry;
+		entry.name.assign((const char*)bytes, strnlen((const char*)bytes, MAX_NAME));
+		entry.offset = readU32(bytes + 48);
+		entry.size = readU32(bytes + 52);
+		entry.frequency = readU32(bytes + 56);
+		entry.format = readU16(bytes + 60);
+		entry.channels = bytes[62];
+		valid = (size_t)entry.offset + entry.size <= mSize;
+		mEntries.push_back(entry);
+	}
+
+	if (!valid)
+	{
+		std::cout << "Asset archive " << path << " is invalid!" << std::endl;
+		close();
+		return false;
+	}
+	return true;
+}
+
+void Sudoku::AssetArchive::close()
+{
+	if (mData != nullptr)
+	{
+		unmapFile(mData, mSize);
+		mData = nullptr;
+	}
+	mSize = 0;
+	mEntries.clear();
+}
+
+bool Sudoku::AssetArchive::isOpen() const
+{
+	return mData != nullptr;
+}
+
+void Sudoku::AssetArchive::addLooseDirectory(const std::string& directory)
+{
+	mLooseDirectories.push_back(directory);
+}
+
+const Sudoku::AssetEntry* Sudoku::AssetArchive::find(const char* name) const
+{
+	// Few enough assets for a linear search
+	for (size_t i = 0; i < mEntries.size(); i++)
+	{
+		if (mEntries[i].name == name)
+		{
+			return &mEntries[i];
+		}
+	}
+	return nullptr;
+}
+
+const uint8_t* Sudoku::AssetArchive::getData(const AssetEntry& entry) const
+{
+	return mData + entry.offset;
+}
+
+SDL_RWops* Sudoku::AssetArchive::openRW(const char* name) const
+{
+	// Read straight from the mapped archive
+	const AssetEntry* entry = find(name);
+	if (entry != nullptr && entry->frequency == 0)
+	{
+		return SDL_RWFromConstMem(getData(*entry), (int)entry->size);
+	}
+
+	// Fall back to loose files for development
+	for (size_t i = 0; i < mLooseDirectories.size(); i++)
+	{
+		SDL_RWops* file = SDL_RWFromFile((mLooseDirectories[i] + name).c_str(), "rb");
+		if (file != nullptr)
+		{
+			return file;
+		}
+	}
+	std::cout << "Could not find asset " << name << "! Error: " << SDL_GetError() << std::endl;
+	return nullptr;
+}
+
+bool Sudoku::AssetArchive::pack(const std::string& path, const std::string& directory, const char* const* names, const int totalNames,
+	const int frequency, const uint16_t format, const int channels)
+{
+	std::vector<uint8_t> index((size_t)HEADER_SIZE + (size_t)totalNames * ENTRY_SIZE, 0);
+	std::vector<uint8_t> data;
+
+	// Header
+	memcpy(index.data(), ARCHIVE_MAGIC, 4);
+	writeU32(index.data() + 4, ARCHIVE_VERSION);
+	writeU32(index.data() + 8, (uint32_t)totalNames);
+
+	for (int i = 0; i < totalNames; i++)
+	{
+		const std::string name = names[i];
+		const std::string filePath = directory + "/" + name;
+		if (name.size() > (size_t)MAX_NAME)
+		{
+			std::cout << "Asset name " << name << " is too long!" << std::endl;
+			return false;
+		}
+
+		// Decode WAV files to the mixer's format so they can be played without decoding or copying
+		std::vector<uint8_t> bytes;
+		const bool decode = frequency != 0 && hasExtension(name, ".wav");
+		if (decode ? !decodeWav(filePath, frequency, format, channels, bytes) : !readFile(filePath, bytes))
+		{
+			std::cout << "Could not read asset " << filePath << "!" << std::endl;
+			return false;
+		}
+
+		// Align data
+		while ((index.size() + data.size()) % ALIGNMENT != 0)
+		{
+			data.push_back(0);
+		}
+
+		uint8_t* entry = index.data() + HEADER_SIZE + i * ENTRY_SIZE;
+		memcpy(entry, name.c_str(), name.size());
+		writeU32(entry + 48, (uint32_t)(index.size() + data.size()));
+		writeU32(entry + 52, (uint32_t)bytes.size());
+		writeU32(entry + 56, decode ? (uint32_t)frequency : 0);
+		writeU16(entry + 60, decode ? format : 0);
+		entry[62] = decode ? (uint8_t)channels : 0;
+		data.insert(data.end(), bytes.begin(), bytes.end());
+	}
+
+	// Write and flush temporary file, then replace any previous archive
+	const std::string temporaryPath = path + ".tmp";
+	FILE* file = openFile(temporaryPath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	bool success = fwrite(index.data(), 1, index.size(), file) == index.size() && fwrite(data.data(), 1, data.size(), file) == data.size() && syncFile(file);
+	success = fclose(file) == 0 && success;
+	if (!success)
+	{
+		remove(temporaryPath.c_str());
+		return false;
+	}
+	return replaceFile(temporaryPath.c_str(), path.c_str());
+}
@@ -0,0 +1,83 @@
+/* Packed asset archive memory-mapped once and served through SDL_RWops, with loose files as a fallback */
+#pragma once
+#include <SDL.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Sudoku
+{
+	// One asset in the archive index
+	struct AssetEntry
+	{
+		// Asset name (file name inside the assets folder)
+		std::string name;
+
+		// Position and size of the data in the archive
+		uint32_t offset = 0;
+		uint32_t size = 0;
+
+		// Raw samples pre-decoded to this audio format (frequency 0 means the file is stored as it is)
+		uint32_t frequency = 0;
+		uint16_t format = 0;
+		uint8_t channels = 0;
+	};
+
+	class AssetArchive
+	{
+	public:
+		// Bytes of the header and of each index entry, and the maximum name length
+		static const int HEADER_SIZE = 16;
+		static const int ENTRY_SIZE = 64;
+		static const int MAX_NAME = 47;
+
+		// Data of every asset starts on this boundary (keeps pre-decoded samples aligned)
+		static const int ALIGNMENT = 16;
+
+	private:
+		// Mapped archive file
+		const uint8_t* mData;
+		size_t mSize;
+
+		// Index of the archive
+		std::vector<AssetEntry> mEntries;
+
+		// Folders searched for loose files when an asset is not in the archive
+		std::vector<std::string> mLooseDirectories;
+
+	public:
+		// Constructor
+		AssetArchive();
+
+		// Destructor to unmap the archive
+		~AssetArchive();
+
+		// Map an archive and read its index (returns false if it is missing or invalid)
+		bool open(const std::string& path);
+
+		// Unmap the archive
+		void close();
+
+		// Check if an archive is mapped
+		bool isOpen() const;
+
+		// Add a folder to search for loose files (searched in the order added)
+		void addLooseDirectory(const std::string& directory);
+
+		// Find an asset in the archive (nullptr if it is not packed)
+		const AssetEntry* find(const char* name) const;
+
+		// Get data of an asset in the archive
+		const uint8_t* getData(const AssetEntry& entry) const;
+
+		// Open an asset from the archive without copying it, or from a loose file (nullptr if neither exists)
+		SDL_RWops* openRW(const char* name) const;
+
+		// Pack assets from a folder into an archive, decoding WAV files to an audio format if frequency is not 0
+		static bool pack(const std::string& path, const std::string& directory, const char* const* names, const int totalNames,
+			const int frequency, const uint16_t format, const int channels);
+
+	};
+
+};
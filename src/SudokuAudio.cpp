@@ -0,0 +1,319 @@
+#include "SudokuAudio.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+	// Sound effect assets and volumes (in SoundEffect order, -1 keeps the default volume)
+	const char* const gEffectNames[] = { "effect.wav", "new_game.wav", "win.wav", "checksolution.wav" };
+	const int gEffectVolumes[] = { -1, 50, -1, 15 };
+
+	// Page size assumed when touching pre-decoded samples
+	const int PAGE_SIZE = 4096;
+}
+
+// Clicks come fastest, so they get the most channels
+const int Sudoku::Audio::EFFECT_CHANNELS[(int)SoundEffect::TOTAL_EFFECTS] = { 4, 1, 1, 2 };
+
+Sudoku::Audio::Audio()
+	: mAssets(nullptr), mReady(false),
+	  mDeviceOpen(false), mFrequency(0), mRequestedBuffer(LOW_LATENCY_BUFFER), mBuffer(0),
+	  mMusic(nullptr), mEffects(),
+	  mFirstChannel(), mNextChannel(), mLatencies(), mLatencyCount(0),
+	  mPlayMusic(false), mLoadTime(0.0)
+{
+	for (int i = 0; i < TOTAL_CHANNELS; i++)
+	{
+		mPendingInput[i] = 0;
+	}
+}
+
+Sudoku::Audio::~Audio()
+{
+	stop();
+}
+
+Mix_Chunk* Sudoku::Audio::loadEffect(const char* name) const
+{
+	// Decode the WAV file unless the archive holds pre-decoded samples
+	const AssetEntry* entry = mAssets->find(name);
+	int frequency;
+	Uint16 format;
+	int channels;
+	if (entry == nullptr || entry->frequency == 0 || Mix_QuerySpec(&frequency, &format, &channels) == 0)
+	{
+		SDL_RWops* file = mAssets->openRW(name);
+		return file != nullptr ? Mix_LoadWAV_RW(file, 1) : nullptr;
+	}
+	// Pre-decoded samples in the mixer's format are used in place (the mixer never writes to a chunk's samples)
+	if (entry->frequency == (uint32_t)frequency && entry->format == format && entry->channels == channels)
+	{
+		// Touch every page now so the first time an effect plays it doesn't wait for the mapped file to be read
+		const uint8_t* samples = mAssets->getData(*entry);
+		volatile uint8_t touched = 0;
+		for (uint32_t i = 0; i < entry->size; i += PAGE_SIZE)
+		{
+			touched ^= samples[i];
+		}
+		return Mix_QuickLoad_RAW(const_cast<Uint8*>(samples), entry->size);
+	}
+
+	// The device opened with another format, so convert a copy of the samples to it (the archive may not hold the WAV file)
+	SDL_AudioCVT convert;
+	if (SDL_BuildAudioCVT(&convert, entry->format, (Uint8)entry->channels, (int)entry->frequency, format, (Uint8)channels, frequency) < 0)
+	{
+		return nullptr;
+	}
+	convert.len = (int)entry->size;
+	convert.buf = (Uint8*)SDL_malloc((size_t)convert.len * convert.len_mult);
+	if (convert.buf == nullptr)
+	{
+		return nullptr;
+	}
+	memcpy(convert.buf, mAssets->getData(*entry), entry->size);
+	if (SDL_ConvertAudio(&convert) < 0)
+	{
+		SDL_free(convert.buf);
+		return nullptr;
+	}
+
+	// Chunk owns its converted samples, the same as a decoded WAV file, so Mix_FreeChunk frees them
+	Mix_Chunk* chunk = (Mix_Chunk*)SDL_malloc(sizeof(Mix_Chunk));
+	if (chunk == nullptr)
+	{
+		SDL_free(convert.buf);
+		return nullptr;
+	}
+	chunk->allocated = 1;
+	chunk->abuf = convert.buf;
+	chunk->alen = (Uint32)convert.len_cvt;
+	chunk->volume = MIX_MAX_VOLUME;
+	return chunk;
+}
+
+bool Sudoku::Audio::openDevice()
+{
+	mBuffer = mRequestedBuffer;
+	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, mBuffer) == 0)
+	{
+		return true;
+	}
+	if (mBuffer == DEFAULT_BUFFER)
+	{
+		return false;
+	}
+
+	// Some devices refuse small buffers
+	std::cerr << "Could not open audio with a " << mBuffer << " frame buffer, using " << DEFAULT_BUFFER << "! Error: " << Mix_GetError() << std::endl;
+	mBuffer = DEFAULT_BUFFER;
+	return Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, mBuffer) == 0;
+}
+
+void Sudoku::Audio::load()
+{
+	const Uint64 loadStart = SDL_GetPerformanceCounter();
+
+	// Initialise SDL audio subsystem and SDL_mixer only when audio is first needed
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
+	{
+		std::cerr << "SDL audio could not initialize! Error: " << SDL_GetError() << std::endl;
+	}
+	else if (!openDevice())
+	{
+		std::cerr << "SDL_mixer coud not initialize! Error: " << Mix_GetError() << std::endl;
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	}
+	else
+	{
+		mDeviceOpen = true;
+		Uint16 format;
+		int channels;
+		Mix_QuerySpec(&mFrequency, &format, &channels);
+
+		// Give every effect its own channels, reserved so nothing else plays on them
+		Mix_AllocateChannels(TOTAL_CHANNELS);
+		Mix_ReserveChannels(TOTAL_CHANNELS);
+		int channel = 0;
+		for (int i = 0; i < (int)SoundEffect::TOTAL_EFFECTS; i++)
+		{
+			mFirstChannel[i] = channel;
+			mNextChannel[i] = 0;
+			Mix_GroupChannels(channel, channel + EFFECT_CHANNELS[i] - 1, i);
+			channel += EFFECT_CHANNELS[i];
+		}
+
+		// One hook after every mix measures the effects started since the last one
+		Mix_SetPostMix(&Audio::onPostMix, this);
+
+		// Load sound effects first since they are short
+		for (int i = 0; i < (int)SoundEffect::TOTAL_EFFECTS; i++)
+		{
+			mEffects[i] = loadEffect(gEffectNames[i]);
+			if (mEffects[i] == nullptr)
+			{
+				std::cout << "Failed to load " << gEffectNames[i] << "! Error: " << Mix_GetError() << std::endl;
+			}
+			else if (gEffectVolumes[i] >= 0)
+			{
+				Mix_VolumeChunk(mEffects[i], gEffectVolumes[i]);
+			}
+		}
+
+		// Load music theme and play it on forever loop (streamed from the archive)
+		SDL_RWops* musicFile = mAssets->openRW("loop_music.mp3");
+		mMusic = musicFile != nullptr ? Mix_LoadMUS_RW(musicFile, 1) : nullptr;
+		if (mMusic == nullptr)
+		{
+			std::cout << "Failed to load music! Error: " << Mix_GetError() << std::endl;
+		}
+		else if (mPlayMusic)
+		{
+			Mix_PlayMusic(mMusic, -1);
+		}
+	}
+
+	mLoadTime = (double)(SDL_GetPerformanceCounter() - loadStart) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+	mReady = true;
+}
+
+void Sudoku::Audio::setBufferSize(const int frames)
+{
+	mRequestedBuffer = frames > 0 ? frames : LOW_LATENCY_BUFFER;
+}
+
+void Sudoku::Audio::start(const AssetArchive* assets, const bool playMusic)
+{
+	if (!mLoader.joinable() && !mReady)
+	{
+		mAssets = assets;
+		mPlayMusic = playMusic;
+		mLoader = std::thread(&Audio::load, this);
+	}
+}
+
+void Sudoku::Audio::stop()
+{
+	// Decoding can't be interrupted, so wait for it to finish
+	if (mLoader.joinable())
+	{
+		mLoader.join();
+	}
+
+	if (mDeviceOpen)
+	{
+		Mix_SetPostMix(nullptr, nullptr);
+		Mix_HaltChannel(-1);
+		Mix_HaltMusic();
+		for (int i = 0; i < (int)SoundEffect::TOTAL_EFFECTS; i++)
+		{
+			if (mEffects[i] != nullptr)
+			{
+				Mix_FreeChunk(mEffects[i]);
+				mEffects[i] = nullptr;
+			}
+		}
+		if (mMusic != nullptr)
+		{
+			Mix_FreeMusic(mMusic);
+			mMusic = nullptr;
+		}
+		Mix_CloseAudio();
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		mDeviceOpen = false;
+	}
+	mBuffer = 0;
+	mReady = false;
+}
+
+bool Sudoku::Audio::isReady() const
+{
+	return mReady;
+}
+
+double Sudoku::Audio::getLoadTime() const
+{
+	return mReady ? mLoadTime : 0.0;
+}
+
+int Sudoku::Audio::getBufferSize() const
+{
+	return mReady ? mBuffer : 0;
+}
+
+void Sudoku::Audio::onPostMix(void* data, Uint8*, int)
+{
+	Audio* audio = (Audio*)data;
+	for (int channel = 0; channel < TOTAL_CHANNELS; channel++)
+	{
+		// Only a channel playing now has had its effect mixed into this buffer
+		if (audio->mPendingInput[channel].load(std::memory_order_relaxed) == 0 || !Mix_Playing(channel))
+		{
+			continue;
+		}
+		const Uint64 inputTime = audio->mPendingInput[channel].exchange(0);
+		const int count = audio->mLatencyCount.load(std::memory_order_relaxed);
+		if (inputTime == 0 || count >= MAX_LATENCY_SAMPLES)
+		{
+			continue;
+		}
+
+		// The samples mixed now are heard after the buffer ahead of them has played out
+		const double mixed = (double)(SDL_GetPerformanceCounter() - inputTime) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+		const double buffered = audio->mFrequency > 0 ? audio->mBuffer * 1000.0 / audio->mFrequency : 0.0;
+		audio->mLatencies[count] = mixed + buffered;
+		audio->mLatencyCount.store(count + 1, std::memory_order_release);
+	}
+}
+
+void Sudoku::Audio::play(const SoundEffect effect, const Uint64 inputTime)
+{
+	const int index = (int)effect;
+	if (!mReady || mEffects[index] == nullptr)
+	{
+		return;
+	}
+
+	// Take the effect's oldest channel, cutting it short if it is still playing
+	const int channel = mFirstChannel[index] + mNextChannel[index];
+	mNextChannel[index] = (mNextChannel[index] + 1) % EFFECT_CHANNELS[index];
+
+	// Halt the channel first, so the post-mix hook only measures it once the effect has started playing on it
+	Mix_HaltChannel(channel);
+	mPendingInput[channel] = inputTime != 0 ? inputTime : SDL_GetPerformanceCounter();
+	if (Mix_PlayChannel(channel, mEffects[index], 0) != channel)
+	{
+		mPendingInput[channel] = 0;
+	}
+}
+
+int Sudoku::Audio::getLatencyCount() const
+{
+	return mLatencyCount.load(std::memory_order_acquire);
+}
+
+Sudoku::PhaseSummary Sudoku::Audio::getLatencySummary() const
+{
+	PhaseSummary summary;
+	const int count = getLatencyCount();
+	if (count == 0)
+	{
+		return summary;
+	}
+	std::vector<double> sorted(mLatencies, mLatencies + count);
+	double total = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		total += sorted[i];
+	}
+
+	// Partially sort for the 99th percentile
+	const size_t p99Index = (sorted.size() * 99) / 100;
+	std::nth_element(sorted.begin(), sorted.begin() + p99Index, sorted.end());
+
+	summary.p99 = sorted[p99Index];
+	summary.min = *std::min_element(sorted.begin(), sorted.end());
+	summary.max = *std::max_element(sorted.begin(), sorted.end());
+	summary.avg = total / count;
+	return summary;
+}
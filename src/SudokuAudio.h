@@ -0,0 +1,119 @@
+/* Audio device, music and sound effects loaded on a background thread, with input to sound latency measurement */
+#pragma once
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include "SudokuAssetArchive.h"
+#include "SudokuFrameStats.h"
+
+namespace Sudoku
+{
+	// Sound effects that can be played
+	enum class SoundEffect
+	{
+		CLICK = 0,
+		NEW_GAME = 1,
+		WIN = 2,
+		CHECK_SOLUTION = 3,
+		TOTAL_EFFECTS = 4
+	};
+
+	class Audio
+	{
+	public:
+		// Device buffer sizes (sample frames): low latency is the default, the old default is the fallback if the device refuses a small buffer
+		static const int LOW_LATENCY_BUFFER = 512;
+		static const int DEFAULT_BUFFER = 2048;
+
+		// Channels reserved for each sound effect (in SoundEffect order, adding up to TOTAL_CHANNELS), so playing one never searches for a free channel
+		static const int EFFECT_CHANNELS[(int)SoundEffect::TOTAL_EFFECTS];
+		static const int TOTAL_CHANNELS = 8;
+
+		// Latency samples kept (later effects are played but not measured)
+		static const int MAX_LATENCY_SAMPLES = 4096;
+
+	private:
+		// Assets holding music and sound effects (read-only while the loader runs)
+		const AssetArchive* mAssets;
+
+		// Loader thread and whether it has finished (set last, so the audio below is safe to use once it is true)
+		std::thread mLoader;
+		std::atomic<bool> mReady;
+
+		// Audio device opened by the loader thread, its frequency and the buffer size asked for and opened with (sample frames)
+		bool mDeviceOpen;
+		int mFrequency;
+		int mRequestedBuffer;
+		int mBuffer;
+
+		// Music theme and sound effects
+		Mix_Music* mMusic;
+		Mix_Chunk* mEffects[(int)SoundEffect::TOTAL_EFFECTS];
+
+		// First channel of each effect and the channel it plays on next (the oldest of its channels)
+		int mFirstChannel[(int)SoundEffect::TOTAL_EFFECTS];
+		int mNextChannel[(int)SoundEffect::TOTAL_EFFECTS];
+
+		// Input time (performance counter) of the effect started on each channel, cleared once the mixer has first mixed it
+		std::atomic<Uint64> mPendingInput[TOTAL_CHANNELS];
+
+		// Input to sound latencies written by the mixer thread (milliseconds; only the first mLatencyCount are set)
+		double mLatencies[MAX_LATENCY_SAMPLES];
+		std::atomic<int> mLatencyCount;
+
+		// Play music as soon as it has loaded
+		bool mPlayMusic;
+
+		// Time taken by the loader thread (milliseconds)
+		double mLoadTime;
+
+	private:
+		// Load a sound effect, playing pre-decoded samples straight from the archive when they match the mixer's format (converting a copy when they don't)
+		Mix_Chunk* loadEffect(const char* name) const;
+
+		// Open the audio device with the buffer size asked for, or the default buffer if the device refuses it
+		bool openDevice();
+
+		// Loader thread: open the audio device and decode music and sound effects
+		void load();
+
+		// Mixer hook after every mix: measure the latency of effects mixed for the first time
+		static void onPostMix(void* data, Uint8* stream, int length);
+
+	public:
+		// Constructor
+		Audio();
+
+		// Destructor to stop the loader and free audio
+		~Audio();
+
+		// Set device buffer size in sample frames (call before start; smaller buffers play effects sooner but need the mixer to keep up)
+		void setBufferSize(const int frames);
+
+		// Start loading from the assets on a background thread (the first frame never waits for audio)
+		void start(const AssetArchive* assets, const bool playMusic);
+
+		// Wait for the loader, free music and sound effects and close the audio device
+		void stop();
+
+		// Check if audio has finished loading
+		bool isReady() const;
+
+		// Get time taken to load audio (milliseconds, 0 until ready)
+		double getLoadTime() const;
+
+		// Get buffer size the device was opened with (sample frames, 0 until ready)
+		int getBufferSize() const;
+
+		// Play a sound effect for input handled at a time (performance counter, 0 for now; ignored until audio is ready)
+		void play(const SoundEffect effect, const Uint64 inputTime = 0);
+
+		// Get number of effects measured and the summary of their latency from input to leaving the device (milliseconds)
+		int getLatencyCount() const;
+		PhaseSummary getLatencySummary() const;
+
+	};
+
+};
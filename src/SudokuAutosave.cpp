@@ -0,0 +1,72 @@
+#include "SudokuAutosave.h"
+
+Sudoku::Autosave::Autosave()
+	: mStop(false), mHasPending(false)
+{
+
+}
+
+Sudoku::Autosave::~Autosave()
+{
+	stop();
+}
+
+void Sudoku::Autosave::start(const std::string& path)
+{
+	if (!mWorker.joinable())
+	{
+		mPath = path;
+		mStop = false;
+		mWorker = std::thread(&Autosave::run, this);
+	}
+}
+
+void Sudoku::Autosave::stop()
+{
+	if (mWorker.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStop = true;
+		}
+		mCondition.notify_one();
+		mWorker.join();
+	}
+}
+
+void Sudoku::Autosave::submit(const Snapshot& snapshot)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPending = snapshot;
+		mHasPending = true;
+	}
+	mCondition.notify_one();
+}
+
+bool Sudoku::Autosave::load(Snapshot& snapshot) const
+{
+	return !mPath.empty() && readSnapshotFile(mPath, snapshot);
+}
+
+void Sudoku::Autosave::run()
+{
+	while (true)
+	{
+		Snapshot snapshot;
+		{
+			// Wait for a snapshot, writing the last one before stopping
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this] { return mStop || mHasPending; });
+			if (!mHasPending)
+			{
+				return;
+			}
+			snapshot = mPending;
+			mHasPending = false;
+		}
+
+		// Slow storage only holds up this thread
+		writeSnapshotFile(mPath, snapshot);
+	}
+}
@@ -0,0 +1,52 @@
+/* Autosave writing game snapshots on a background I/O thread */
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "SudokuSnapshot.h"
+
+namespace Sudoku
+{
+	class Autosave
+	{
+	private:
+		// Snapshot file path
+		std::string mPath;
+
+		// I/O thread and the lock protecting the pending snapshot
+		std::thread mWorker;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mStop;
+
+		// Latest snapshot waiting to be written (newer snapshots replace it, so bursts of changes coalesce)
+		Snapshot mPending;
+		bool mHasPending;
+
+	private:
+		// I/O thread loop
+		void run();
+
+	public:
+		// Constructor
+		Autosave();
+
+		// Destructor to write the last snapshot and stop the I/O thread
+		~Autosave();
+
+		// Set snapshot file path and start the I/O thread
+		void start(const std::string& path);
+
+		// Write any pending snapshot and stop the I/O thread
+		void stop();
+
+		// Queue snapshot to be written (only copies it, never waits for I/O)
+		void submit(const Snapshot& snapshot);
+
+		// Read the saved snapshot (call before starting a game)
+		bool load(Snapshot& snapshot) const;
+
+	};
+
+};
@@ -0,0 +1,1029 @@
+#include "SudokuBandEnumerator.h"
+#include <algorithm>
+#include <memory>
+#include <string.h>
+
+namespace
+{
+	// Orders of the 3 numbers of a box-row (smallest first) across its 3 columns
+	const int PERMUTATIONS[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+
+	struct TripleTable
+	{
+		// Every set of 3 numbers (bit 0 = number 1), its numbers smallest first, and the index of a set from its mask (-1 unless it has 3 numbers)
+		uint16_t tripleMasks[84];
+		int tripleNumbers[84][3];
+		int8_t tripleIndex[512];
+
+		// Permutation placing the numbers at positions a, b and c of a triple in the 3 columns (index a * 9 + b * 3 + c)
+		int8_t permutationIndex[27];
+	};
+
+	// Build the triple tables once
+	TripleTable* buildTriples()
+	{
+		TripleTable* table = new TripleTable();
+		int totalTriples = 0;
+		for (int mask = 0; mask < 512; mask++)
+		{
+			table->tripleIndex[mask] = -1;
+			int numbers = 0;
+			for (int num = 1; num <= 9; num++)
+			{
+				if (mask & (1 << (num - 1)))
+				{
+					numbers++;
+				}
+			}
+			if (numbers != 3)
+			{
+				continue;
+			}
+			table->tripleMasks[totalTriples] = (uint16_t)mask;
+			table->tripleIndex[mask] = (int8_t)totalTriples;
+			int found = 0;
+			for (int num = 1; num <= 9; num++)
+			{
+				if (mask & (1 << (num - 1)))
+				{
+					table->tripleNumbers[totalTriples][found++] = num;
+				}
+			}
+			totalTriples++;
+		}
+
+		for (int i = 0; i < 27; i++)
+		{
+			table->permutationIndex[i] = -1;
+		}
+		for (int permutation = 0; permutation < 6; permutation++)
+		{
+			const int* order = PERMUTATIONS[permutation];
+			table->permutationIndex[order[0] * 9 + order[1] * 3 + order[2]] = (int8_t)permutation;
+		}
+		return table;
+	}
+
+	const TripleTable& getTriples()
+	{
+		static const std::unique_ptr<const TripleTable> table(buildTriples());
+		return *table;
+	}
+
+	// Key of 9 column triples (7 bits each)
+	uint64_t signature(const uint16_t* triples, const TripleTable& table)
+	{
+		uint64_t key = 0;
+		for (int col = 0; col < 9; col++)
+		{
+			key = (key << 7) | (uint64_t)table.tripleIndex[triples[col] & 0x1FF];
+		}
+		return key;
+	}
+
+	// Share of a first band from its column signature, spread so every share gets about as many
+	int shareOf(const uint64_t key, const int totalShares)
+	{
+		return (int)(((key * 0x9E3779B97F4A7C15ull) >> 32) % (uint64_t)totalShares);
+	}
+
+	// Ways to relabel the numbers of a grid (9!)
+	const uint64_t RELABELS = 362880;
+
+	// Place value of the column within each box in a layout code
+	const int BOX_PLACES[3] = { 9, 3, 1 };
+
+	// Count the ways a band without givens can hold exactly the numbers missing from each column, by the row each number takes in each box
+	uint64_t countOpenBand(const uint16_t* missing)
+	{
+		// Numbers of each column, smallest first
+		int numbers[9][3];
+		for (int col = 0; col < 9; col++)
+		{
+			int found = 0;
+			for (int num = 0; num < 9; num++)
+			{
+				if (missing[col] & (1u << num))
+				{
+					if (found == 3)
+					{
+						return 0;
+					}
+					numbers[col][found++] = num;
+				}
+			}
+			if (found != 3)
+			{
+				return 0;
+			}
+		}
+
+		// Rows can go in any order, so the first column takes its numbers top to bottom and the count is 6 times that
+		int firstRows[9];
+		int secondRows[9];
+		for (int i = 0; i < 3; i++)
+		{
+			firstRows[numbers[0][i]] = i;
+		}
+		uint64_t total = 0;
+		for (int order1 = 0; order1 < 6; order1++)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				firstRows[numbers[1][i]] = PERMUTATIONS[order1][i];
+			}
+			for (int order2 = 0; order2 < 6; order2++)
+			{
+				for (int i = 0; i < 3; i++)
+				{
+					firstRows[numbers[2][i]] = PERMUTATIONS[order2][i];
+				}
+
+				// Orders of each column of the second box keeping every number out of its row in the first box
+				int fits[3][6];
+				int totalFits[3];
+				for (int box = 0; box < 3; box++)
+				{
+					const int* nums = numbers[3 + box];
+					totalFits[box] = 0;
+					for (int order = 0; order < 6; order++)
+					{
+						const int* rows = PERMUTATIONS[order];
+						if (rows[0] != firstRows[nums[0]] && rows[1] != firstRows[nums[1]] && rows[2] != firstRows[nums[2]])
+						{
+							fits[box][totalFits[box]++] = order;
+						}
+					}
+				}
+
+				// Each number's row in the last box is the one left, and each column of it needs all three rows
+				for (int a = 0; a < totalFits[0]; a++)
+				{
+					for (int i = 0; i < 3; i++)
+					{
+						secondRows[numbers[3][i]] = PERMUTATIONS[fits[0][a]][i];
+					}
+					for (int b = 0; b < totalFits[1]; b++)
+					{
+						for (int i = 0; i < 3; i++)
+						{
+							secondRows[numbers[4][i]] = PERMUTATIONS[fits[1][b]][i];
+						}
+						for (int c = 0; c < totalFits[2]; c++)
+						{
+							for (int i = 0; i < 3; i++)
+							{
+								secondRows[numbers[5][i]] = PERMUTATIONS[fits[2][c]][i];
+							}
+							bool valid = true;
+							for (int col = 6; col < 9 && valid; col++)
+							{
+								int rows = 0;
+								for (int i = 0; i < 3; i++)
+								{
+									const int num = numbers[col][i];
+									rows |= 1 << (3 - firstRows[num] - secondRows[num]);
+								}
+								valid = rows == 7;
+							}
+							total += valid ? 1 : 0;
+						}
+					}
+				}
+			}
+		}
+		return total * 6;
+	}
+
+	// Key of a band's layout: the column within each box every number takes as a code from 0 to 26, counting how many numbers take each
+	// code in 2 bits (a column holds 3 numbers, so no count carries)
+	uint64_t layoutKey(const int* numbers)
+	{
+		int codes[9] = { };
+		for (int cell = 0; cell < 27; cell++)
+		{
+			const int col = cell % 9;
+			codes[numbers[cell] - 1] += (col % 3) * BOX_PLACES[col / 3];
+		}
+		uint64_t key = 0;
+		for (int num = 0; num < 9; num++)
+		{
+			key += 1ull << (2 * codes[num]);
+		}
+		return key;
+	}
+
+	// Smallest layout key over every order of the boxes and of the columns within each box (so equivalent layouts share it)
+	uint64_t canonicalLayout(const uint64_t key)
+	{
+		uint64_t best = key;
+		for (int boxOrder = 0; boxOrder < 6; boxOrder++)
+		{
+			const int* boxes = PERMUTATIONS[boxOrder];
+			for (int colOrders = 0; colOrders < 216; colOrders++)
+			{
+				const int* cols[3] = { PERMUTATIONS[colOrders / 36], PERMUTATIONS[(colOrders / 6) % 6], PERMUTATIONS[colOrders % 6] };
+				uint64_t moved = 0;
+				for (int code = 0; code < 27; code++)
+				{
+					const uint64_t count = (key >> (2 * code)) & 3;
+					if (count == 0)
+					{
+						continue;
+					}
+					const int place[3] = { code / 9, (code / 3) % 3, code % 3 };
+					int movedCode = 0;
+					for (int i = 0; i < 3; i++)
+					{
+						movedCode += cols[boxes[i]][place[boxes[i]]] * BOX_PLACES[i];
+					}
+					moved += count << (2 * movedCode);
+				}
+				best = moved < best ? moved : best;
+			}
+		}
+		return best;
+	}
+
+	// Check if a status means the call was stopped early
+	bool isStopped(const Sudoku::SolveStatus status)
+	{
+		return status == Sudoku::SolveStatus::CANCELLED || status == Sudoku::SolveStatus::TIMED_OUT;
+	}
+}
+
+Sudoku::BandEnumerator::BandEnumerator()
+	: mGrid(), mOrder(), mTransposed(false), mGivenColumns(), mBandGivens(), mEmpty(true),
+	  mStatus(SolveStatus::NO_SOLUTION), mBandsUntilCheck(SolveLimits::CHECK_INTERVAL),
+	  mFirstBandsDone(0), mCounted()
+{
+
+}
+
+bool Sudoku::BandEnumerator::setGrid(const int* grid)
+{
+	// Givens can't repeat a number in a row, col or block
+	uint16_t rows[9] = { };
+	uint16_t cols[9] = { };
+	uint16_t blocks[9] = { };
+	int bandGivens[3] = { };
+	int stackGivens[3] = { };
+	for (int cell = 0; cell < 81; cell++)
+	{
+		const int num = grid[cell];
+		if (num < 1 || num > 9)
+		{
+			continue;
+		}
+		const int row = cell / 9;
+		const int col = cell % 9;
+		const int block = (row / 3) * 3 + col / 3;
+		const uint16_t bit = (uint16_t)(1u << (num - 1));
+		if ((rows[row] | cols[col] | blocks[block]) & bit)
+		{
+			return false;
+		}
+		rows[row] |= bit;
+		cols[col] |= bit;
+		blocks[block] |= bit;
+		bandGivens[row / 3]++;
+		stackGivens[col / 3]++;
+	}
+
+	// Transposing keeps the number of completions, so enumerate the way round with the fullest band
+	int bestBand = 0;
+	int bestStack = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		bestBand = bandGivens[i] > bestBand ? bandGivens[i] : bestBand;
+		bestStack = stackGivens[i] > bestStack ? stackGivens[i] : bestStack;
+	}
+	int previousGrid[81];
+	int previousOrder[3];
+	const bool previousTransposed = mTransposed;
+	memcpy(previousGrid, mGrid, sizeof(mGrid));
+	memcpy(previousOrder, mOrder, sizeof(mOrder));
+	mTransposed = bestStack > bestBand;
+	const int* givens = mTransposed ? stackGivens : bandGivens;
+	mEmpty = givens[0] + givens[1] + givens[2] == 0;
+
+	// So does reordering bands: fuller bands first leave fewer bands to list
+	for (int i = 0; i < 3; i++)
+	{
+		mOrder[i] = i;
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = i + 1; j < 3; j++)
+		{
+			if (givens[mOrder[j]] > givens[mOrder[i]])
+			{
+				const int swap = mOrder[i];
+				mOrder[i] = mOrder[j];
+				mOrder[j] = swap;
+			}
+		}
+	}
+
+	for (int band = 0; band < 3; band++)
+	{
+		mBandGivens[band] = givens[mOrder[band]];
+		for (int col = 0; col < 9; col++)
+		{
+			mGivenColumns[band][col] = 0;
+		}
+		for (int row = 0; row < 3; row++)
+		{
+			for (int col = 0; col < 9; col++)
+			{
+				const int sourceRow = mOrder[band] * 3 + row;
+				const int num = mTransposed ? grid[col * 9 + sourceRow] : grid[sourceRow * 9 + col];
+				const int value = num >= 1 && num <= 9 ? num : 0;
+				mGrid[band * 27 + row * 9 + col] = value;
+				if (value != 0)
+				{
+					mGivenColumns[band][col] |= (uint16_t)(1u << (value - 1));
+				}
+			}
+		}
+	}
+
+	// Memos only hold for the grid they were made for, so counting a grid share by share keeps them
+	if (mTransposed != previousTransposed || memcmp(mOrder, previousOrder, sizeof(mOrder)) != 0 || memcmp(mGrid, previousGrid, sizeof(mGrid)) != 0)
+	{
+		mSecondMemo.clear();
+		mThirdMemo.clear();
+		mFirstBandsDone.store(0, std::memory_order_relaxed);
+		std::lock_guard<std::mutex> lock(mCountedMutex);
+		mCounted = GridCount();
+	}
+	return true;
+}
+
+void Sudoku::BandEnumerator::prepare(const int band, const uint16_t* used, BandContext& context) const
+{
+	const TripleTable& table = getTriples();
+
+	// Numbers used above, or given in the same column of another band, can't go in a column
+	for (int col = 0; col < 9; col++)
+	{
+		context.allowed[col] = (uint16_t)(0x1FF & ~used[col]);
+		for (int other = 0; other < 3; other++)
+		{
+			if (other != band)
+			{
+				context.allowed[col] &= (uint16_t)~mGivenColumns[other][col];
+			}
+		}
+	}
+	for (int i = 0; i < 27; i++)
+	{
+		context.givens[i] = mGrid[band * 27 + i];
+	}
+
+	// List every way of filling each box-row, filed under the triple it uses
+	memset(context.counts, 0, sizeof(context.counts));
+	for (int row = 0; row < 3; row++)
+	{
+		for (int box = 0; box < 3; box++)
+		{
+			uint16_t cellAllowed[3];
+			for (int i = 0; i < 3; i++)
+			{
+				const int col = box * 3 + i;
+				const int given = context.givens[row * 9 + col];
+				cellAllowed[i] = given != 0 ? (uint16_t)(context.allowed[col] & (1u << (given - 1))) : context.allowed[col];
+			}
+			for (uint16_t bits0 = cellAllowed[0]; bits0 != 0; bits0 &= bits0 - 1)
+			{
+				const uint16_t bit0 = bits0 & (uint16_t)(0u - bits0);
+				for (uint16_t bits1 = cellAllowed[1] & (uint16_t)~bit0; bits1 != 0; bits1 &= bits1 - 1)
+				{
+					const uint16_t bit1 = bits1 & (uint16_t)(0u - bits1);
+					for (uint16_t bits2 = cellAllowed[2] & (uint16_t)~(bit0 | bit1); bits2 != 0; bits2 &= bits2 - 1)
+					{
+						const uint16_t bit2 = bits2 & (uint16_t)(0u - bits2);
+						const int triple = table.tripleIndex[bit0 | bit1 | bit2];
+
+						// Rank of each number within its triple gives the permutation
+						const int rank0 = (bit0 > bit1) + (bit0 > bit2);
+						const int rank1 = (bit1 > bit0) + (bit1 > bit2);
+						const int rank2 = (bit2 > bit0) + (bit2 > bit1);
+						uint8_t& count = context.counts[row][box][triple];
+						context.orders[row][box][triple][count++] = (uint8_t)table.permutationIndex[rank0 * 9 + rank1 * 3 + rank2];
+					}
+				}
+			}
+		}
+	}
+
+	// Triples each box-row can take at all, for patterns to be built from
+	for (int row = 0; row < 3; row++)
+	{
+		for (int box = 0; box < 3; box++)
+		{
+			int total = 0;
+			for (int triple = 0; triple < 84; triple++)
+			{
+				if (context.counts[row][box][triple] != 0)
+				{
+					context.viable[row][box][total++] = (uint8_t)triple;
+				}
+			}
+			context.totalViable[row][box] = total;
+		}
+	}
+}
+
+template <class Visit>
+bool Sudoku::BandEnumerator::forEachPattern(const BandContext& context, Visit visit)
+{
+	const TripleTable& table = getTriples();
+	uint8_t triples[9];
+
+	// First row: a triple for each of the first two boxes, the last box taking the numbers left
+	for (int a = 0; a < context.totalViable[0][0]; a++)
+	{
+		triples[0] = context.viable[0][0][a];
+		const uint16_t box0 = table.tripleMasks[triples[0]];
+		for (int b = 0; b < context.totalViable[0][1]; b++)
+		{
+			triples[1] = context.viable[0][1][b];
+			const uint16_t box1 = table.tripleMasks[triples[1]];
+			const uint16_t box2 = (uint16_t)(0x1FF & ~(box0 | box1));
+			if (box1 & box0)
+			{
+				continue;
+			}
+			triples[2] = (uint8_t)table.tripleIndex[box2];
+			if (context.counts[0][2][triples[2]] == 0)
+			{
+				continue;
+			}
+
+			// Second row: the same, keeping out of each box's first row triple
+			for (int c = 0; c < context.totalViable[1][0]; c++)
+			{
+				triples[3] = context.viable[1][0][c];
+				const uint16_t box3 = table.tripleMasks[triples[3]];
+				if (box3 & box0)
+				{
+					continue;
+				}
+				for (int d = 0; d < context.totalViable[1][1]; d++)
+				{
+					triples[4] = context.viable[1][1][d];
+					const uint16_t box4 = table.tripleMasks[triples[4]];
+					const uint16_t box5 = (uint16_t)(0x1FF & ~(box3 | box4));
+					if ((box4 & box1) || (box4 & box3) || (box5 & box2))
+					{
+						continue;
+					}
+					triples[5] = (uint8_t)table.tripleIndex[box5];
+					if (context.counts[1][2][triples[5]] == 0)
+					{
+						continue;
+					}
+
+					// Third row: what each box still needs (always a valid row)
+					triples[6] = (uint8_t)table.tripleIndex[0x1FF & ~(box0 | box3)];
+					triples[7] = (uint8_t)table.tripleIndex[0x1FF & ~(box1 | box4)];
+					triples[8] = (uint8_t)table.tripleIndex[0x1FF & ~(box2 | box5)];
+					if (context.counts[2][0][triples[6]] == 0 || context.counts[2][1][triples[7]] == 0 || context.counts[2][2][triples[8]] == 0)
+					{
+						continue;
+					}
+					if (!visit((const uint8_t*)triples))
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+uint64_t Sudoku::BandEnumerator::countBand(const BandContext& context)
+{
+	uint64_t total = 0;
+	forEachPattern(context, [&context, &total](const uint8_t* triples)
+	{
+		// Box-rows of a pattern are filled independently of each other
+		uint64_t ways = 1;
+		for (int boxRow = 0; boxRow < 9; boxRow++)
+		{
+			ways *= context.counts[boxRow / 3][boxRow % 3][triples[boxRow]];
+		}
+		total += ways;
+		return true;
+	});
+	return total;
+}
+
+template <class Visit>
+bool Sudoku::BandEnumerator::forEachBand(const BandContext& context, const uint16_t* used, const bool rowOrdered, Visit visit)
+{
+	const TripleTable& table = getTriples();
+	uint16_t columns[9];
+	int numbers[27];
+	int choice[9];
+	return forEachPattern(context, [&](const uint8_t* triples)
+	{
+		// Rows of the first box hold different numbers, so exactly one order of six has their smallest numbers rising
+		if (rowOrdered)
+		{
+			const uint16_t first = table.tripleMasks[triples[0]];
+			const uint16_t second = table.tripleMasks[triples[3]];
+			const uint16_t third = table.tripleMasks[triples[6]];
+			if ((first & (0u - first)) > (second & (0u - second)) || (second & (0u - second)) > (third & (0u - third)))
+			{
+				return true;
+			}
+		}
+
+		// Count through every ordering of every box-row like an odometer, refilling the box-rows that changed
+		for (int boxRow = 0; boxRow < 9; boxRow++)
+		{
+			choice[boxRow] = 0;
+		}
+		int changed = 0;
+		while (true)
+		{
+			for (int boxRow = changed; boxRow < 9; boxRow++)
+			{
+				const int row = boxRow / 3;
+				const int box = boxRow % 3;
+				const uint8_t triple = triples[boxRow];
+				const int* order = PERMUTATIONS[context.orders[row][box][triple][choice[boxRow]]];
+				for (int i = 0; i < 3; i++)
+				{
+					numbers[row * 9 + box * 3 + i] = table.tripleNumbers[triple][order[i]];
+				}
+			}
+
+			// Column masks only depend on which numbers landed in each column
+			for (int col = 0; col < 9; col++)
+			{
+				columns[col] = (uint16_t)(used[col] | (1u << (numbers[col] - 1)) | (1u << (numbers[9 + col] - 1)) | (1u << (numbers[18 + col] - 1)));
+			}
+
+			if (--mBandsUntilCheck == 0)
+			{
+				mBandsUntilCheck = SolveLimits::CHECK_INTERVAL;
+				if (mLimits.reached(mStatus))
+				{
+					return false;
+				}
+			}
+			if (!visit((const uint16_t*)columns, (const int*)numbers))
+			{
+				return false;
+			}
+
+			// Advance the last box-row that has orderings left
+			changed = 8;
+			while (changed >= 0 && ++choice[changed] == context.counts[changed / 3][changed % 3][triples[changed]])
+			{
+				choice[changed] = 0;
+				changed--;
+			}
+			if (changed < 0)
+			{
+				return true;
+			}
+		}
+	});
+}
+
+uint64_t Sudoku::BandEnumerator::countLastTwo(const uint16_t* used)
+{
+	const TripleTable& table = getTriples();
+	const uint64_t key = signature(used, table);
+	std::unordered_map<uint64_t, uint64_t>::const_iterator found = mSecondMemo.find(key);
+	if (found != mSecondMemo.end())
+	{
+		return found->second;
+	}
+
+	// Reordering the rows of a second band without givens keeps its columns, so list one order and count it six times
+	const bool rowOrdered = mBandGivens[1] == 0;
+	BandContext second;
+	prepare(1, used, second);
+	uint64_t total = 0;
+	forEachBand(second, used, rowOrdered, [this, &total](const uint16_t* columns, const int*)
+	{
+		total += countLast(columns);
+		return true;
+	});
+	total *= rowOrdered ? 6 : 1;
+
+	// A count cut short by the limits is only part of the count
+	if (!isStopped(mStatus))
+	{
+		if (mSecondMemo.size() >= MEMO_LIMIT)
+		{
+			mSecondMemo.clear();
+		}
+		mSecondMemo[key] = total;
+	}
+	return total;
+}
+
+uint64_t Sudoku::BandEnumerator::countLast(const uint16_t* used)
+{
+	// The last band holds exactly the numbers each column is missing
+	const TripleTable& table = getTriples();
+	uint16_t missing[9];
+	for (int col = 0; col < 9; col++)
+	{
+		missing[col] = (uint16_t)(0x1FF & ~used[col]);
+	}
+	const uint64_t key = signature(missing, table);
+	std::unordered_map<uint64_t, uint64_t>::const_iterator found = mThirdMemo.find(key);
+	if (found != mThirdMemo.end())
+	{
+		return found->second;
+	}
+
+	// Without givens the last band only needs the row of each number in each box
+	uint64_t total = 0;
+	if (mBandGivens[2] == 0)
+	{
+		total = countOpenBand(missing);
+	}
+	else
+	{
+		BandContext third;
+		prepare(2, used, third);
+		total = countBand(third);
+	}
+	if (mThirdMemo.size() >= MEMO_LIMIT)
+	{
+		mThirdMemo.clear();
+	}
+	mThirdMemo[key] = total;
+	return total;
+}
+
+void Sudoku::BandEnumerator::copyGrid(const int* bands, int* grid) const
+{
+	for (int band = 0; band < 3; band++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			for (int col = 0; col < 9; col++)
+			{
+				const int sourceRow = mOrder[band] * 3 + row;
+				const int num = bands[band * 27 + row * 9 + col];
+				if (mTransposed)
+				{
+					grid[col * 9 + sourceRow] = num;
+				}
+				else
+				{
+					grid[sourceRow * 9 + col] = num;
+				}
+			}
+		}
+	}
+}
+
+template <class Visit>
+void Sudoku::BandEnumerator::forEachTopRowBand(Visit visit)
+{
+	int grid[81] = { };
+	for (int col = 0; col < 9; col++)
+	{
+		grid[col] = col + 1;
+	}
+	BandEnumerator enumerator;
+	enumerator.setGrid(grid);
+	const uint16_t none[9] = { };
+	BandContext first;
+	enumerator.prepare(0, none, first);
+	enumerator.forEachBand(first, none, false, visit);
+}
+
+Sudoku::BandEnumerator::BandClasses* Sudoku::BandEnumerator::buildBandClasses()
+{
+	// Bands sharing a layout also share its column masks up to relabelling, so only each layout needs to be brought to its smallest form
+	std::unordered_map<uint64_t, uint64_t> layouts;
+	forEachTopRowBand([&layouts](const uint16_t*, const int* numbers)
+	{
+		layouts[layoutKey(numbers)]++;
+		return true;
+	});
+
+	BandClasses* bandClasses = new BandClasses();
+	std::unordered_map<uint64_t, int> classOfCanonical;
+	for (std::unordered_map<uint64_t, uint64_t>::const_iterator layout = layouts.begin(); layout != layouts.end(); ++layout)
+	{
+		const uint64_t canonical = canonicalLayout(layout->first);
+		std::unordered_map<uint64_t, int>::const_iterator found = classOfCanonical.find(canonical);
+		int classIndex = 0;
+		if (found != classOfCanonical.end())
+		{
+			classIndex = found->second;
+		}
+		else
+		{
+			// Any numbering of the canonical layout gives columns of some band in the class
+			BandClass bandClass = { };
+			int num = 0;
+			for (int code = 0; code < 27; code++)
+			{
+				for (uint64_t count = (canonical >> (2 * code)) & 3; count > 0; count--)
+				{
+					bandClass.columns[code / 9] |= (uint16_t)(1u << num);
+					bandClass.columns[3 + (code / 3) % 3] |= (uint16_t)(1u << num);
+					bandClass.columns[6 + code % 3] |= (uint16_t)(1u << num);
+					num++;
+				}
+			}
+			classIndex = (int)bandClasses->classes.size();
+			classOfCanonical[canonical] = classIndex;
+			bandClasses->classes.push_back(bandClass);
+		}
+		bandClasses->classes[classIndex].bands += layout->second;
+		bandClasses->classOf[layout->first] = classIndex;
+	}
+	return bandClasses;
+}
+
+const Sudoku::BandEnumerator::BandClasses& Sudoku::BandEnumerator::getBandClasses()
+{
+	static const std::unique_ptr<const BandClasses> bandClasses(buildBandClasses());
+	return *bandClasses;
+}
+
+void Sudoku::BandEnumerator::addProgress(const uint64_t firstBands, const uint64_t completions)
+{
+	mFirstBandsDone.fetch_add(firstBands, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(mCountedMutex);
+	mCounted.add(completions, firstBands);
+}
+
+Sudoku::GridCount Sudoku::BandEnumerator::count(const int* grid, const SolveLimits& limits)
+{
+	return countShare(grid, 0, 1, limits);
+}
+
+Sudoku::GridCount Sudoku::BandEnumerator::countShare(const int* grid, const int share, const int totalShares, const SolveLimits& limits)
+{
+	mLimits = limits;
+	mStatus = SolveStatus::SOLVED;
+	if (!setGrid(grid))
+	{
+		mStatus = SolveStatus::NO_SOLUTION;
+		return GridCount();
+	}
+
+	// The empty grid goes class by class, each standing for its bands with the top row in order relabelled every way
+	GridCount total;
+	if (mEmpty)
+	{
+		const BandClasses& bandClasses = getBandClasses();
+		for (size_t i = 0; i < bandClasses.classes.size(); i++)
+		{
+			if (totalShares > 1 && (int)(i % (size_t)totalShares) != share)
+			{
+				continue;
+			}
+			const BandClass& bandClass = bandClasses.classes[i];
+			const uint64_t completions = countLastTwo(bandClass.columns);
+			if (isStopped(mStatus))
+			{
+				break;
+			}
+			total.add(completions, bandClass.bands * RELABELS);
+			addProgress(bandClass.bands * RELABELS, completions);
+		}
+		return total;
+	}
+
+	// Every first band is weighed by how many ways the last two can complete it
+	const uint16_t none[9] = { };
+	BandContext first;
+	prepare(0, none, first);
+	const TripleTable& table = getTriples();
+	forEachBand(first, none, false, [&](const uint16_t* columns, const int*)
+	{
+		if (totalShares > 1 && shareOf(signature(columns, table), totalShares) != share)
+		{
+			return true;
+		}
+		const uint64_t completions = countLastTwo(columns);
+		if (isStopped(mStatus))
+		{
+			return false;
+		}
+		total.add(completions);
+		addProgress(1, completions);
+		return true;
+	});
+
+	if (!isStopped(mStatus) && total.isZero())
+	{
+		mStatus = SolveStatus::NO_SOLUTION;
+	}
+	return total;
+}
+
+uint64_t Sudoku::BandEnumerator::countFirstBands(const int* grid)
+{
+	if (!setGrid(grid))
+	{
+		return 0;
+	}
+	const uint16_t none[9] = { };
+	BandContext first;
+	prepare(0, none, first);
+	return countBand(first);
+}
+
+uint64_t Sudoku::BandEnumerator::enumerate(const int* grid, const std::function<bool(const int*)>& visit, const SolveLimits& limits)
+{
+	mLimits = limits;
+	mStatus = SolveStatus::SOLVED;
+	if (!setGrid(grid))
+	{
+		mStatus = SolveStatus::NO_SOLUTION;
+		return 0;
+	}
+
+	const uint16_t none[9] = { };
+	int bands[81];
+	int result[81];
+	uint64_t visited = 0;
+	BandContext first;
+	prepare(0, none, first);
+	forEachBand(first, none, false, [&](const uint16_t* firstColumns, const int* firstNumbers)
+	{
+		memcpy(bands, firstNumbers, sizeof(int) * 27);
+		BandContext second;
+		prepare(1, firstColumns, second);
+		return forEachBand(second, firstColumns, false, [&](const uint16_t* secondColumns, const int* secondNumbers)
+		{
+			memcpy(bands + 27, secondNumbers, sizeof(int) * 27);
+			BandContext third;
+			prepare(2, secondColumns, third);
+			return forEachBand(third, secondColumns, false, [&](const uint16_t*, const int* thirdNumbers)
+			{
+				memcpy(bands + 54, thirdNumbers, sizeof(int) * 27);
+				copyGrid(bands, result);
+				visited++;
+				return visit(result);
+			});
+		});
+	});
+
+	if (!isStopped(mStatus) && visited == 0)
+	{
+		mStatus = SolveStatus::NO_SOLUTION;
+	}
+	return visited;
+}
+
+bool Sudoku::BandEnumerator::sample(const int* grid, std::minstd_rand& random, int* result, const SolveLimits& limits)
+{
+	mLimits = limits;
+	mStatus = SolveStatus::SOLVED;
+	if (!setGrid(grid))
+	{
+		mStatus = SolveStatus::NO_SOLUTION;
+		return false;
+	}
+
+	// Pick the grid's position in enumeration order, then walk down to it band by band, skipping whole subtrees by their counts
+	const uint16_t none[9] = { };
+	int bands[81];
+	uint16_t used[9];
+	uint64_t pick = 0;
+	BandContext context;
+	if (mEmpty)
+	{
+		// The empty grid picks a grid with the top row in order (a class by its completions, then a band of the class), relabelled at the end
+		const BandClasses& bandClasses = getBandClasses();
+		std::vector<uint64_t> completions;
+		uint64_t total = 0;
+		for (size_t i = 0; i < bandClasses.classes.size(); i++)
+		{
+			completions.push_back(countLastTwo(bandClasses.classes[i].columns));
+			if (isStopped(mStatus))
+			{
+				return false;
+			}
+			total += bandClasses.classes[i].bands * completions[i];
+		}
+		pick = std::uniform_int_distribution<uint64_t>(0, total - 1)(random);
+		int classIndex = 0;
+		while (pick >= bandClasses.classes[classIndex].bands * completions[classIndex])
+		{
+			pick -= bandClasses.classes[classIndex].bands * completions[classIndex];
+			classIndex++;
+		}
+		uint64_t bandIndex = pick / completions[classIndex];
+		pick %= completions[classIndex];
+		forEachTopRowBand([&](const uint16_t* columns, const int* numbers)
+		{
+			if (bandClasses.classOf.at(layoutKey(numbers)) != classIndex || bandIndex-- != 0)
+			{
+				return true;
+			}
+			memcpy(bands, numbers, sizeof(int) * 27);
+			memcpy(used, columns, sizeof(used));
+			return false;
+		});
+	}
+	else
+	{
+		const GridCount total = count(grid, limits);
+		if (total.isZero() || isStopped(mStatus) || !total.fits64())
+		{
+			return false;
+		}
+		pick = std::uniform_int_distribution<uint64_t>(0, total.low - 1)(random);
+
+		prepare(0, none, context);
+		forEachBand(context, none, false, [&](const uint16_t* columns, const int* numbers)
+		{
+			const uint64_t weight = countLastTwo(columns);
+			if (pick < weight)
+			{
+				memcpy(bands, numbers, sizeof(int) * 27);
+				memcpy(used, columns, sizeof(used));
+				return false;
+			}
+			pick -= weight;
+			return !isStopped(mStatus);
+		});
+		if (isStopped(mStatus))
+		{
+			return false;
+		}
+	}
+
+	prepare(1, used, context);
+	forEachBand(context, used, false, [&](const uint16_t* columns, const int* numbers)
+	{
+		const uint64_t weight = countLast(columns);
+		if (pick < weight)
+		{
+			memcpy(bands + 27, numbers, sizeof(int) * 27);
+			memcpy(used, columns, sizeof(used));
+			return false;
+		}
+		pick -= weight;
+		return true;
+	});
+	if (isStopped(mStatus))
+	{
+		return false;
+	}
+
+	prepare(2, used, context);
+	forEachBand(context, used, false, [&](const uint16_t*, const int* numbers)
+	{
+		if (pick == 0)
+		{
+			memcpy(bands + 54, numbers, sizeof(int) * 27);
+			return false;
+		}
+		pick--;
+		return true;
+	});
+	if (isStopped(mStatus))
+	{
+		return false;
+	}
+
+	copyGrid(bands, result);
+	if (mEmpty)
+	{
+		int labels[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		std::shuffle(labels + 1, labels + 10, random);
+		for (int cell = 0; cell < 81; cell++)
+		{
+			result[cell] = labels[result[cell]];
+		}
+	}
+	mStatus = SolveStatus::SOLVED;
+	return true;
+}
+
+Sudoku::SolveStatus Sudoku::BandEnumerator::getStatus() const
+{
+	return mStatus;
+}
+
+uint64_t Sudoku::BandEnumerator::getFirstBandsDone() const
+{
+	return mFirstBandsDone.load(std::memory_order_relaxed);
+}
+
+Sudoku::GridCount Sudoku::BandEnumerator::getCounted() const
+{
+	std::lock_guard<std::mutex> lock(mCountedMutex);
+	return mCounted;
+}
@@ -0,0 +1,212 @@
+/* Complete grid enumeration, counting and uniform sampling band by band from the patterns each band can take */
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SudokuSolveLimits.h"
+
+namespace Sudoku
+{
+	// Count of complete grids in 128 bits, as an empty grid has about 6.67e21 (more than 64 bits hold)
+	struct GridCount
+	{
+		uint64_t high = 0;
+		uint64_t low = 0;
+
+		GridCount(const uint64_t count = 0)
+			: low(count)
+		{
+
+		}
+
+		// Add a count times a factor (64 by 64 bits in 32-bit halves, so no compiler extension is needed)
+		void add(const uint64_t count, const uint64_t factor = 1)
+		{
+			const uint64_t low0 = count & 0xFFFFFFFFull;
+			const uint64_t high0 = count >> 32;
+			const uint64_t low1 = factor & 0xFFFFFFFFull;
+			const uint64_t high1 = factor >> 32;
+			const uint64_t lowLow = low0 * low1;
+			const uint64_t lowHigh = low0 * high1;
+			const uint64_t highLow = high0 * low1;
+			const uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFull) + (highLow & 0xFFFFFFFFull);
+			const uint64_t productLow = (middle << 32) | (lowLow & 0xFFFFFFFFull);
+			const uint64_t productHigh = high0 * high1 + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+			low += productLow;
+			high += productHigh + (low < productLow ? 1 : 0);
+		}
+
+		void add(const GridCount& count)
+		{
+			low += count.low;
+			high += count.high + (low < count.low ? 1 : 0);
+		}
+
+		bool isZero() const
+		{
+			return high == 0 && low == 0;
+		}
+
+		// Check if the count fits in 64 bits (low then holds all of it)
+		bool fits64() const
+		{
+			return high == 0;
+		}
+
+		double toDouble() const
+		{
+			return high * 18446744073709551616.0 + low;
+		}
+
+		// Write the count in decimal, dividing by 10 a 32-bit part at a time
+		std::string toString() const
+		{
+			uint32_t parts[4] = { (uint32_t)(high >> 32), (uint32_t)high, (uint32_t)(low >> 32), (uint32_t)low };
+			std::string digits;
+			bool left = true;
+			while (left)
+			{
+				uint64_t remainder = 0;
+				left = false;
+				for (int i = 0; i < 4; i++)
+				{
+					const uint64_t value = (remainder << 32) | parts[i];
+					parts[i] = (uint32_t)(value / 10);
+					remainder = value % 10;
+					left = left || parts[i] != 0;
+				}
+				digits.insert(digits.begin(), (char)('0' + remainder));
+			}
+			return digits;
+		}
+	};
+
+	class BandEnumerator
+	{
+	public:
+		// Memoized counts kept before a memo is cleared
+		static const size_t MEMO_LIMIT = 1 << 22;
+
+	private:
+		// For one band: numbers it may use in each column, its givens, how many orderings of each of the 84 triples fit every box-row (and which),
+		// and the triples that fit at all
+		struct BandContext
+		{
+			uint16_t allowed[9];
+			int givens[27];
+			uint8_t counts[3][3][84];
+			uint8_t orders[3][3][84][6];
+			uint8_t viable[3][3][84];
+			int totalViable[3][3];
+		};
+
+		// First bands of the empty grid with the top row in order, in classes whose last two bands complete the same number of ways: the same
+		// layout of numbers across the columns of each box, up to relabelling, reordering the columns of a box and reordering the boxes (44 classes)
+		struct BandClass
+		{
+			uint16_t columns[9];
+			uint64_t bands;
+		};
+
+		struct BandClasses
+		{
+			std::vector<BandClass> classes;
+			std::unordered_map<uint64_t, int> classOf;
+		};
+
+		// Grid as enumerated: transposed or not, with its bands reordered so the bands with the most givens come first
+		int mGrid[81];
+		int mOrder[3];
+		bool mTransposed;
+
+		// Givens in each column of each band (bit 0 = number 1), how many each band has, and if the grid has none at all
+		uint16_t mGivenColumns[3][9];
+		int mBandGivens[3];
+		bool mEmpty;
+
+		// Completions of the last two bands for the column signature of the first band, and of the last band for the signature of the first two
+		std::unordered_map<uint64_t, uint64_t> mSecondMemo;
+		std::unordered_map<uint64_t, uint64_t> mThirdMemo;
+
+		// Limits of the current call, how it ended and bands left before the limits are checked
+		SolveLimits mLimits;
+		SolveStatus mStatus;
+		unsigned int mBandsUntilCheck;
+
+		// First bands counted through and completions counted since the grid last changed (read by other threads for progress)
+		std::atomic<uint64_t> mFirstBandsDone;
+		mutable std::mutex mCountedMutex;
+		GridCount mCounted;
+
+	private:
+		// Set grid to enumerate, returning false if its givens repeat a number in a row, col or block (memos are kept if the grid is the same)
+		bool setGrid(const int* grid);
+
+		// Work out what a band may hold under the numbers used in each column by the bands before it
+		void prepare(const int band, const uint16_t* used, BandContext& context) const;
+
+		// Visit every band pattern a context allows: the triple of numbers in each box-row, up to their order within the box-row (so a pattern
+		// stands for up to 6^9 bands, and there are 94080 patterns of an empty band); returns false if visit did
+		template <class Visit>
+		static bool forEachPattern(const BandContext& context, Visit visit);
+
+		// Count bands a context allows without listing them
+		static uint64_t countBand(const BandContext& context);
+
+		// Visit every band a context allows with the numbers used in each column including it and its 27 numbers (returns false if stopped);
+		// rowOrdered visits only the bands whose rows are in one order of six, for a band without givens whose rows can go in any order
+		template <class Visit>
+		bool forEachBand(const BandContext& context, const uint16_t* used, const bool rowOrdered, Visit visit);
+
+		// Visit every first band of the empty grid with the top row in order, and get its classes (built once, the first time they are needed)
+		template <class Visit>
+		static void forEachTopRowBand(Visit visit);
+		static BandClasses* buildBandClasses();
+		static const BandClasses& getBandClasses();
+
+		// Add first bands counted through and their completions to the progress
+		void addProgress(const uint64_t firstBands, const uint64_t completions);
+
+		// Count completions of the last two bands, and of the last band, under the numbers used in each column by the bands before them
+		uint64_t countLastTwo(const uint16_t* used);
+		uint64_t countLast(const uint16_t* used);
+
+		// Copy the three bands of an enumerated grid back into the grid's own orientation and band order
+		void copyGrid(const int* bands, int* grid) const;
+
+	public:
+		// Constructor
+		BandEnumerator();
+
+		// Count complete grids that keep the givens of a grid (0 for empty cells); use getStatus to check the count finished
+		GridCount count(const int* grid, const SolveLimits& limits = SolveLimits());
+
+		// Count only the complete grids whose first band (or band class, for the empty grid) falls in one of totalShares shares (the counts of
+		// every share add up to count)
+		GridCount countShare(const int* grid, const int share, const int totalShares, const SolveLimits& limits = SolveLimits());
+
+		// Count first bands a grid allows (every share goes through all of them, counting the rest of the grid for its own)
+		uint64_t countFirstBands(const int* grid);
+
+		// Visit complete grids that keep the givens of a grid until visit returns false, returning the number visited
+		uint64_t enumerate(const int* grid, const std::function<bool(const int*)>& visit, const SolveLimits& limits = SolveLimits());
+
+		// Pick one of the complete grids that keep the givens of a grid with equal chance, returning false if there is none or the limits were reached
+		// (or if there are too many to pick from in 64 bits, which only a grid nearly as empty as the empty grid has, and it never finishes counting)
+		bool sample(const int* grid, std::minstd_rand& random, int* result, const SolveLimits& limits = SolveLimits());
+
+		// Get status of the last call (SOLVED once it went through every grid, NO_SOLUTION if there were none, or why it stopped)
+		SolveStatus getStatus() const;
+
+		// Get first bands of its shares counted through and completions counted since the grid last changed (safe to call from other threads)
+		uint64_t getFirstBandsDone() const;
+		GridCount getCounted() const;
+
+	};
+
+};
@@ -0,0 +1,208 @@
+#include "SudokuBoard.h"
+
+int Sudoku::Board::getRow(const int index)
+{
+	return index / 9;
+}
+
+int Sudoku::Board::getCol(const int index)
+{
+	return index % 9;
+}
+
+int Sudoku::Board::getBlock(const int index)
+{
+	return (getRow(index) / 3) * 3 + getCol(index) / 3;
+}
+
+Sudoku::Board::Board()
+	: mVersion(0)
+{
+	clear();
+}
+
+inline void Sudoku::Board::addCount(const int index, const int num)
+{
+	unsigned char* counts[3] = { &mRowCounts[getRow(index)][num], &mColCounts[getCol(index)][num], &mBlockCounts[getBlock(index)][num] };
+	uint16_t* conflicts[3] = { &mRowConflicts[getRow(index)], &mColConflicts[getCol(index)], &mBlockConflicts[getBlock(index)] };
+	const uint16_t bit = (uint16_t)(1u << (num - 1));
+	for (int unit = 0; unit < 3; unit++)
+	{
+		// Digit becomes repeated in this unit
+		if (++(*counts[unit]) == 2)
+		{
+			*conflicts[unit] |= bit;
+			mConflicts++;
+		}
+	}
+
+	// Digit is now present in its row, col and block
+	mRowMasks[getRow(index)] |= bit;
+	mColMasks[getCol(index)] |= bit;
+	mBlockMasks[getBlock(index)] |= bit;
+	mFilled++;
+}
+
+inline void Sudoku::Board::removeCount(const int index, const int num)
+{
+	unsigned char* counts[3] = { &mRowCounts[getRow(index)][num], &mColCounts[getCol(index)][num], &mBlockCounts[getBlock(index)][num] };
+	uint16_t* conflicts[3] = { &mRowConflicts[getRow(index)], &mColConflicts[getCol(index)], &mBlockConflicts[getBlock(index)] };
+	const uint16_t bit = (uint16_t)(1u << (num - 1));
+	for (int unit = 0; unit < 3; unit++)
+	{
+		// Digit is no longer repeated in this unit
+		if ((*counts[unit])-- == 2)
+		{
+			*conflicts[unit] &= (uint16_t)~bit;
+			mConflicts--;
+		}
+	}
+
+	// Clear digit from units where it no longer appears
+	if (*counts[0] == 0) mRowMasks[getRow(index)] &= ~bit;
+	if (*counts[1] == 0) mColMasks[getCol(index)] &= ~bit;
+	if (*counts[2] == 0) mBlockMasks[getBlock(index)] &= ~bit;
+	mFilled--;
+}
+
+void Sudoku::Board::clear()
+{
+	for (int i = 0; i < 81; i++)
+	{
+		mValues[i] = 0;
+		mSolution[i] = 0;
+		mGivens[i] = false;
+		mNotes[i] = 0;
+	}
+
+	for (int unit = 0; unit < 9; unit++)
+	{
+		mRowMasks[unit] = 0;
+		mColMasks[unit] = 0;
+		mBlockMasks[unit] = 0;
+		mRowConflicts[unit] = 0;
+		mColConflicts[unit] = 0;
+		mBlockConflicts[unit] = 0;
+
+		for (int num = 0; num < 10; num++)
+		{
+			mRowCounts[unit][num] = 0;
+			mColCounts[unit][num] = 0;
+			mBlockCounts[unit][num] = 0;
+		}
+	}
+
+	mFilled = 0;
+	mConflicts = 0;
+	mVersion++;
+}
+
+void Sudoku::Board::load(const int* values, const int* solution, const bool* givens)
+{
+	clear();
+	for (int i = 0; i < 81; i++)
+	{
+		setValue(i, values[i]);
+		mSolution[i] = (unsigned char)solution[i];
+		mGivens[i] = givens[i];
+	}
+}
+
+void Sudoku::Board::setValue(const int index, const int num)
+{
+	const int previous = mValues[index];
+	if (previous == num)
+	{
+		return;
+	}
+
+	if (previous != 0)
+	{
+		removeCount(index, previous);
+	}
+	if (num != 0)
+	{
+		addCount(index, num);
+	}
+	mValues[index] = (unsigned char)num;
+	mVersion++;
+}
+
+int Sudoku::Board::getValue(const int index) const
+{
+	return mValues[index];
+}
+
+bool Sudoku::Board::isGiven(const int index) const
+{
+	return mGivens[index];
+}
+
+int Sudoku::Board::getSolution(const int index) const
+{
+	return mSolution[index];
+}
+
+bool Sudoku::Board::isConflict(const int index) const
+{
+	// An empty cell has no bit, so it is never a conflict
+	const uint16_t bit = (uint16_t)((1u << mValues[index]) >> 1);
+	return ((mRowConflicts[getRow(index)] | mColConflicts[getCol(index)] | mBlockConflicts[getBlock(index)]) & bit) != 0;
+}
+
+bool Sudoku::Board::isCorrect(const int index) const
+{
+	// Imported puzzles may not have a stored solution
+	if (mSolution[index] == 0)
+	{
+		return mValues[index] != 0 && !isConflict(index);
+	}
+	return mValues[index] == mSolution[index];
+}
+
+void Sudoku::Board::setNotes(const int index, const uint16_t notes)
+{
+	if (mNotes[index] != notes)
+	{
+		mNotes[index] = notes;
+		mVersion++;
+	}
+}
+
+uint16_t Sudoku::Board::getNotes(const int index) const
+{
+	return mNotes[index];
+}
+
+uint16_t Sudoku::Board::getCandidates(const int index) const
+{
+	return (uint16_t)(0x1FF & ~(mRowMasks[getRow(index)] | mColMasks[getCol(index)] | mBlockMasks[getBlock(index)]));
+}
+
+int Sudoku::Board::getFilled() const
+{
+	return mFilled;
+}
+
+bool Sudoku::Board::hasConflicts() const
+{
+	return mConflicts != 0;
+}
+
+bool Sudoku::Board::isSolved() const
+{
+	return mFilled == 81 && mConflicts == 0;
+}
+
+unsigned int Sudoku::Board::getVersion() const
+{
+	return mVersion;
+}
+
+void Sudoku::Board::copyValues(int* grid) const
+{
+	for (int i = 0; i < 81; i++)
+	{
+		grid[i] = mValues[i];
+	}
+}
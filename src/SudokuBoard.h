@@ -0,0 +1,102 @@
+/* Sudoku board model as structure of arrays (givens, numbers, solution, pencil marks) with incrementally maintained row, column and block digit counts */
+#pragma once
+#include <stdint.h>
+
+namespace Sudoku
+{
+	class Board
+	{
+	private:
+		// Number in each cell of the 9 x 9 = 81 grid (0 = empty)
+		unsigned char mValues[81];
+
+		// Solution of each cell (0 = unknown, as for imported puzzles) and whether it is a given that can't be edited
+		unsigned char mSolution[81];
+		bool mGivens[81];
+
+		// How many times each digit (1 to 9) appears in every row, col and 3 x 3 block
+		unsigned char mRowCounts[9][10];
+		unsigned char mColCounts[9][10];
+		unsigned char mBlockCounts[9][10];
+
+		// Numbers present in every row, col and block (bit 0 = number 1)
+		uint16_t mRowMasks[9];
+		uint16_t mColMasks[9];
+		uint16_t mBlockMasks[9];
+
+		// Numbers repeated in every row, col and block (bit 0 = number 1)
+		uint16_t mRowConflicts[9];
+		uint16_t mColConflicts[9];
+		uint16_t mBlockConflicts[9];
+
+		// Pencil mark candidates of each cell (bit 0 = number 1)
+		uint16_t mNotes[81];
+
+		// Number of filled cells
+		int mFilled;
+
+		// Number of (row, col or block, digit) pairs where the digit appears more than once
+		int mConflicts;
+
+		// Incremented whenever a number or pencil mark changes
+		unsigned int mVersion;
+
+	private:
+		// Add or remove a digit from the counts of its row, col and block
+		inline void addCount(const int index, const int num);
+		inline void removeCount(const int index, const int num);
+
+	public:
+		// Get row, col and block of a 1D index
+		static int getRow(const int index);
+		static int getCol(const int index);
+		static int getBlock(const int index);
+
+		// Constructor
+		Board();
+
+		// Empty every cell and forget the givens and solution
+		void clear();
+
+		// Start a puzzle from its numbers, solution (may be all 0) and givens
+		void load(const int* values, const int* solution, const bool* givens);
+
+		// Set and get number of a cell (0 = empty), updating counts in O(1)
+		void setValue(const int index, const int num);
+		int getValue(const int index) const;
+
+		// Get whether a cell is a given (givens can't be edited)
+		bool isGiven(const int index) const;
+
+		// Get solution of a cell (0 if unknown)
+		int getSolution(const int index) const;
+
+		// Check if the number in a cell is repeated in its row, col or block
+		bool isConflict(const int index) const;
+
+		// Compare number with solution (without a stored solution, a filled cell not repeated in its row, col or block is correct)
+		bool isCorrect(const int index) const;
+
+		// Set and get pencil marks of a cell
+		void setNotes(const int index, const uint16_t notes);
+		uint16_t getNotes(const int index) const;
+
+		// Get numbers not yet present in a cell's row, col and block
+		uint16_t getCandidates(const int index) const;
+
+		// Get number of filled cells and whether any number is repeated
+		int getFilled() const;
+		bool hasConflicts() const;
+
+		// Board is full and no row, col or block repeats a number
+		bool isSolved() const;
+
+		// Get version, which changes whenever a number or pencil mark changes
+		unsigned int getVersion() const;
+
+		// Copy numbers into a 1D array of size 9 x 9 = 81
+		void copyValues(int* grid) const;
+
+	};
+
+};
@@ -1,46 +1,26 @@
 #include "SudokuCell.h"
 
 Sudoku::Cell::Cell()
-	: mEditable(false),
-	  mCharNumber(' '), 
-	  mCharSolution(' ')
+	: mBoard(nullptr),
+	  mIndex(0)
 {
 
 }
 
-void Sudoku::Cell::setNumber(const int number)
+void Sudoku::Cell::setBoard(Board* board, const int index)
 {
-	if (number == 0)
-	{
-		mCharNumber = ' ';
-	}
-	else
-	{
-		mCharNumber = '0' + number;
-	}
+	mBoard = board;
+	mIndex = index;
 }
 
-char Sudoku::Cell::getNumber() const
+int Sudoku::Cell::getIndex() const
 {
-	return mCharNumber;
-}
-
-void Sudoku::Cell::setSolution(const int solution)
-{
-	if (solution == 0)
-	{
-		mCharSolution = ' ';
-	}
-	else
-	{
-		mCharSolution = '0' + solution;
-	}
+	return mIndex;
 }
 
-void Sudoku::Cell::setEditable(const bool editable)
+void Sudoku::Cell::refresh(SDL_Texture* textureCache[])
 {
-	mEditable = editable;
-	if (mEditable)
+	if (isEditable())
 	{
 		mMouseOutColour = { 219, 184, 215, SDL_ALPHA_OPAQUE }; // light purple
 		mMouseOverMotionColour = { 95, 89, 191, SDL_ALPHA_OPAQUE }; // blue
@@ -54,20 +34,24 @@ void Sudoku::Cell::setEditable(const bool editable)
 		mMouseDownColour = { 159, 101, 152, SDL_ALPHA_OPAQUE }; // purple
 		mMouseUpColour = { 159, 101, 152, SDL_ALPHA_OPAQUE }; // purple
 	}
+
+	// Set texture (0 = ' ', 1 to 9 = '1' '2'... '9') and center it onto button
+	setTexture(textureCache[mBoard->getValue(mIndex)]);
+	centerTextureRect();
 }
 
 bool Sudoku::Cell::isEditable() const
 {
-	return mEditable;
+	return mBoard != nullptr && !mBoard->isGiven(mIndex);
 }
 
 void Sudoku::Cell::handleKeyboardEvent(const SDL_Event* event, SDL_Texture* textureCache[])
 {
 	// Handle backspace
-	if (event->key.keysym.sym == SDLK_BACKSPACE && mCharNumber != ' ')
+	if (event->key.keysym.sym == SDLK_BACKSPACE && mBoard->getValue(mIndex) != 0)
 	{
-		// Empty char
-		mCharNumber = ' ';
+		// Empty cell
+		mBoard->setValue(mIndex, 0);
 
 		// Set empty texture
 		setTexture(textureCache[0]);
@@ -75,14 +59,15 @@ void Sudoku::Cell::handleKeyboardEvent(const SDL_Event* event, SDL_Texture* text
 	// Handle text input
 	else if (event->type == SDL_TEXTINPUT)
 	{
-		// Check if integer > 0
-		if (atoi(event->text.text))
+		// Check if single digit from 1 to 9
+		const int number = *(event->text.text) - '0';
+		if (number >= 1 && number <= 9)
 		{
-			// Replace char
-			mCharNumber = *(event->text.text);
+			// Replace number
+			mBoard->setValue(mIndex, number);
 
 			// Set character based on number
-			setTexture(textureCache[atoi(event->text.text)]);
+			setTexture(textureCache[number]);
 
 		}
 	}
@@ -104,6 +89,25 @@ void Sudoku::Cell::setCorrect()
 
 bool Sudoku::Cell::isCorrect() const
 {
-	return mCharNumber == mCharSolution;
+	return mBoard != nullptr && mBoard->isCorrect(mIndex);
+}
+
+bool Sudoku::Cell::isConflict() const
+{
+	return mBoard != nullptr && mBoard->isConflict(mIndex);
+}
+
+void Sudoku::Cell::renderButton(SDL_Renderer* renderer)
+{
+	if (isConflict())
+	{
+		// Repeated numbers are shown in red straight away
+		SDL_SetRenderDrawColor(renderer, 200, 73, 46, SDL_ALPHA_OPAQUE); // red
+		SDL_RenderFillRect(renderer, &getButtonRect());
+	}
+	else
+	{
+		Button::renderButton(renderer);
+	}
 }
 
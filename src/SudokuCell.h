@@ -1,3 +1,4 @@
+/* Button view of one board cell; numbers, solution and givens live in the board model */
 #pragma once
 #include <SDL.h>
 #include <SDL_ttf.h>
@@ -5,32 +6,29 @@
 #include <stdlib.h> // for atoi
 
 #include "Button.h"
+#include "SudokuBoard.h"
 
 namespace Sudoku
 {
 	class Cell : public Button
 	{
 	private:
-		// Define editiability (can type number in cell)
-		bool mEditable;
-
-		// Define number currently displayed and the actual solution
-		char mCharNumber;
-		char mCharSolution;
+		// Board model this cell shows and edits, and this cell's index in it
+		Board* mBoard;
+		int mIndex;
 
 	public:
 		// Constructor
 		Cell();
 
-		// Set and get number
-		void setNumber(const int number);
-		char getNumber() const;
+		// Bind cell to its board model and get its index in it
+		void setBoard(Board* board, const int index);
+		int getIndex() const;
 
-		// Set solution
-		void setSolution(const int solution);
+		// Update colour mapping from editability and texture from number after the board model changed
+		void refresh(SDL_Texture* textureCache[]);
 
-		// Set and get editability (setting editability changes colour mapping for button)
-		void setEditable(const bool editable);
+		// Check editability (givens can't be edited)
 		bool isEditable() const;
 
 		// Handle events
@@ -38,8 +36,15 @@ namespace Sudoku
 
 		void setCorrect();
 		// Compare number with solution and return true if them're equal
+		// (without a stored solution, a filled cell not repeated in its row, col or block is correct)
 		bool isCorrect() const;
 
+		// Check if number is repeated in its row, col or block
+		bool isConflict() const;
+
+		// Render button, highlighting numbers that are repeated in their row, col or block
+		void renderButton(SDL_Renderer* renderer);
+
 	};
 
 };
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "SudokuFrameStats.h"
+
+Sudoku::FrameStats::FrameStats()
+	: mSamples{ },
+	  mCount(0), mCurrent(0),
+	  mTicksPerMs((double)SDL_GetPerformanceFrequency() / 1000.0),
+	  mGenerateTime(0.0)
+{
+
+}
+
+void Sudoku::FrameStats::record(const FramePhase phase, const Uint64 start, const Uint64 end)
+{
+	mSamples[(int)phase][mCurrent] = toMilliseconds(start, end);
+}
+
+void Sudoku::FrameStats::commitFrame()
+{
+	mCurrent = (mCurrent + 1) % CAPACITY;
+	if (mCount < CAPACITY)
+	{
+		mCount++;
+	}
+
+	// Clear the slot being reused so phases skipped this frame read as zero
+	for (int phase = 0; phase < (int)FramePhase::TOTAL_PHASES; phase++)
+	{
+		mSamples[phase][mCurrent] = 0.0;
+	}
+}
+
+void Sudoku::FrameStats::reset()
+{
+	mCount = 0;
+	mCurrent = 0;
+	for (int phase = 0; phase < (int)FramePhase::TOTAL_PHASES; phase++)
+	{
+		std::fill(mSamples[phase], mSamples[phase] + CAPACITY, 0.0);
+	}
+}
+
+Sudoku::PhaseSummary Sudoku::FrameStats::getSummary(const FramePhase phase) const
+{
+	PhaseSummary summary;
+	if (mCount == 0)
+	{
+		return summary;
+	}
+
+	// Committed frames are the mCount slots before the current one
+	double sorted[CAPACITY];
+	double total = 0.0;
+	for (int i = 0; i < mCount; i++)
+	{
+		const int slot = (mCurrent - 1 - i + CAPACITY) % CAPACITY;
+		sorted[i] = mSamples[(int)phase][slot];
+		total += sorted[i];
+	}
+
+	// Partially sort for the 99th percentile
+	const int p99Index = (mCount * 99) / 100;
+	std::nth_element(sorted, sorted + p99Index, sorted + mCount);
+
+	summary.p99 = sorted[p99Index];
+	summary.min = *std::min_element(sorted, sorted + mCount);
+	summary.max = *std::max_element(sorted, sorted + mCount);
+	summary.avg = total / mCount;
+	return summary;
+}
+
+int Sudoku::FrameStats::getCount() const
+{
+	return mCount;
+}
+
+double Sudoku::FrameStats::getLast(const FramePhase phase) const
+{
+	return mSamples[(int)phase][(mCurrent - 1 + CAPACITY) % CAPACITY];
+}
+
+void Sudoku::FrameStats::setGenerateTime(const Uint64 start, const Uint64 end)
+{
+	mGenerateTime = toMilliseconds(start, end);
+}
+
+double Sudoku::FrameStats::getGenerateTime() const
+{
+	return mGenerateTime;
+}
+
+double Sudoku::FrameStats::toMilliseconds(const Uint64 start, const Uint64 end) const
+{
+	return (double)(end - start) / mTicksPerMs;
+}
@@ -0,0 +1,79 @@
+/* Rolling per-frame timing statistics for the performance overlay */
+#pragma once
+#include <SDL.h>
+#include <algorithm>
+
+namespace Sudoku
+{
+	// Phases of a frame that are timed
+	enum class FramePhase
+	{
+		FRAME = 0,
+		EVENTS = 1,
+		LOGIC = 2,
+		RENDER = 3,
+		PRESENT = 4,
+		TOTAL_PHASES = 5
+	};
+
+	// Summary of the samples of one phase (milliseconds)
+	struct PhaseSummary
+	{
+		double min = 0.0;
+		double avg = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	class FrameStats
+	{
+	public:
+		// Number of frames kept in the ring buffer
+		static const int CAPACITY = 240;
+
+	private:
+		// Ring buffer of durations per phase (milliseconds)
+		double mSamples[(int)FramePhase::TOTAL_PHASES][CAPACITY];
+
+		// Number of stored frames and index of the frame being recorded
+		int mCount;
+		int mCurrent;
+
+		// Performance counter ticks per millisecond
+		double mTicksPerMs;
+
+		// Latency of the last generated Sudoku (milliseconds)
+		double mGenerateTime;
+
+	public:
+		// Constructor
+		FrameStats();
+
+		// Record duration of a phase of the current frame from performance counter values
+		void record(const FramePhase phase, const Uint64 start, const Uint64 end);
+
+		// Finish the current frame and start recording the next one
+		void commitFrame();
+
+		// Clear all samples
+		void reset();
+
+		// Get min, average, 99th percentile and max of a phase over the ring buffer
+		PhaseSummary getSummary(const FramePhase phase) const;
+
+		// Get number of stored frames
+		int getCount() const;
+
+		// Get duration of a phase in the last committed frame
+		double getLast(const FramePhase phase) const;
+
+		// Set and get latency of the last generated Sudoku
+		void setGenerateTime(const Uint64 start, const Uint64 end);
+		double getGenerateTime() const;
+
+		// Convert performance counter ticks to milliseconds
+		double toMilliseconds(const Uint64 start, const Uint64 end) const;
+
+	};
+
+};
@@ -0,0 +1,432 @@
+#include "SudokuFuzzer.h"
+#include "SudokuGenerator.h"
+#include "SudokuHintEngine.h"
+#include "SudokuStepSolver.h"
+#include "SudokuVariantSolver.h"
+#include <thread>
+#ifdef SUDOKU_FUZZER
+#include <stdlib.h>
+#endif
+
+namespace
+{
+	// Grids the reference solver or the faster backends find hard (naive backtracking worst cases, contradictions found last)
+	const char* const gAdversarialGrids[] =
+	{
+		"000000000000003085001020000000507000004000100090000000500000073002010000000040009",
+		"800000000003600000070090200050007000000045700000100030001000068008500010090000400",
+		"000000012000000003002300400001800005060070800000009000008500000900040500470006000",
+		"000000000000000000000000000000000000000000000000000000000000000000000000000000000",
+		"000000009000000000000000000000000000000000000000000000000000000000000000123456780",
+		"000000000000000000000000000000000000000000000000000000000000000000000000000000099",
+		"987654321000000000000000000000000000000000000000000000000000000000000000000000000"
+	};
+
+	// Grid as one line of 81 characters with . for blanks
+	std::string gridText(const int* grid)
+	{
+		std::string text(81, '.');
+		for (int i = 0; i < 81; i++)
+		{
+			text[i] = grid[i] >= 1 && grid[i] <= 9 ? (char)('0' + grid[i]) : '.';
+		}
+		return text;
+	}
+
+	// Check that no number repeats in a row, col or block
+	bool isConflictFree(const int* grid)
+	{
+		uint16_t rows[9] = { };
+		uint16_t cols[9] = { };
+		uint16_t blocks[9] = { };
+		for (int cell = 0; cell < 81; cell++)
+		{
+			const int num = grid[cell];
+			if (num < 1 || num > 9)
+			{
+				continue;
+			}
+			const uint16_t bit = (uint16_t)(1u << (num - 1));
+			const int row = cell / 9;
+			const int col = cell % 9;
+			const int block = (row / 3) * 3 + col / 3;
+			if ((rows[row] | cols[col] | blocks[block]) & bit)
+			{
+				return false;
+			}
+			rows[row] |= bit;
+			cols[col] |= bit;
+			blocks[block] |= bit;
+		}
+		return true;
+	}
+
+	// Check that a grid is a full, valid solution keeping every given of a puzzle
+	bool isSolutionOf(const int* solution, const int* puzzle)
+	{
+		for (int cell = 0; cell < 81; cell++)
+		{
+			if (solution[cell] < 1 || solution[cell] > 9 || (puzzle[cell] != 0 && puzzle[cell] != solution[cell]))
+			{
+				return false;
+			}
+		}
+		return isConflictFree(solution);
+	}
+
+	bool isSameGrid(const int* first, const int* second)
+	{
+		for (int cell = 0; cell < 81; cell++)
+		{
+			if (first[cell] != second[cell])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Generate a puzzle of a variant and check it has exactly one solution, the one generated with it
+	template <class Rules>
+	Sudoku::FuzzOutcome checkGenerator(const unsigned int seed, const char* name, std::string& failure)
+	{
+		Sudoku::VariantGenerator<Rules> generator;
+		generator.setSeed(seed);
+		int puzzle[81];
+		int solution[81];
+		generator.generate(puzzle, solution);
+
+		Sudoku::VariantSolver<Rules> solver;
+		solver.getRules() = generator.getRules();
+		int solved[81];
+		if (!solver.setGrid(puzzle) || solver.countSolutions(2) != 1 || !solver.solve(solved) || !isSameGrid(solved, solution) || !isSolutionOf(solution, puzzle))
+		{
+			failure = std::string(name) + " generator made a puzzle without exactly one solution, seed " + std::to_string(seed) + ": " + gridText(puzzle);
+			return Sudoku::FuzzOutcome::FAILED;
+		}
+		return Sudoku::FuzzOutcome::PASSED;
+	}
+}
+
+Sudoku::DifferentialFuzzer::DifferentialFuzzer()
+	: mCases(0), mSkipped(0), mFailures(0), mStop(false)
+{
+
+}
+
+void Sudoku::DifferentialFuzzer::runThread(const int64_t total, const unsigned int seed)
+{
+	std::minstd_rand random(seed);
+	std::string failure;
+	for (int64_t i = 0; i < total && !mStop; i++)
+	{
+		FuzzOutcome outcome = runCase(random, i % REFERENCE_INTERVAL == 0, failure);
+		if (outcome != FuzzOutcome::FAILED && i % GENERATOR_INTERVAL == 0)
+		{
+			outcome = checkGenerators((unsigned int)random(), failure);
+		}
+
+		mCases++;
+		if (outcome == FuzzOutcome::SKIPPED)
+		{
+			mSkipped++;
+		}
+		else if (outcome == FuzzOutcome::FAILED)
+		{
+			fail(failure);
+		}
+	}
+}
+
+Sudoku::FuzzOutcome Sudoku::DifferentialFuzzer::runCase(std::minstd_rand& random, const bool withReference, std::string& failure) const
+{
+	int grid[81] = { };
+	const int kind = (int)(random() % 8);
+	if (kind <= 2)
+	{
+		// Random clues (mostly conflicting when dense, mostly many solutions when sparse)
+		const int clues = (int)(random() % 41);
+		for (int i = 0; i < clues; i++)
+		{
+			grid[random() % 81] = 1 + (int)(random() % 9);
+		}
+	}
+	else if (kind <= 5)
+	{
+		// Generated puzzle with a few clues removed, added, changed or copied
+		const PoolEntry& entry = mPool[random() % mPool.size()];
+		for (int i = 0; i < 81; i++)
+		{
+			grid[i] = entry.puzzle[i];
+		}
+		const int mutations = 1 + (int)(random() % 4);
+		for (int i = 0; i < mutations; i++)
+		{
+			const int cell = (int)(random() % 81);
+			switch (random() % 4)
+			{
+			case 0: grid[cell] = 0; break;
+			case 1: grid[cell] = entry.solution[cell]; break;
+			case 2: grid[cell] = 1 + (int)(random() % 9); break;
+			default: grid[cell] = grid[random() % 81]; break;
+			}
+		}
+	}
+	else if (kind == 6)
+	{
+		// Generated puzzle with numbers relabelled, two rows of a band swapped and maybe transposed (still one solution, moved the same way)
+		const PoolEntry& entry = mPool[random() % mPool.size()];
+		int labels[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		for (int i = 9; i > 1; i--)
+		{
+			const int j = 1 + (int)(random() % (unsigned int)i);
+			const int swap = labels[i];
+			labels[i] = labels[j];
+			labels[j] = swap;
+		}
+		const int band = (int)(random() % 3) * 3;
+		const int row1 = band + (int)(random() % 3);
+		const int row2 = band + (int)(random() % 3);
+		const bool transpose = (random() & 1) != 0;
+
+		int expected[81];
+		for (int cell = 0; cell < 81; cell++)
+		{
+			int row = cell / 9;
+			const int col = cell % 9;
+			row = row == row1 ? row2 : (row == row2 ? row1 : row);
+			const int target = transpose ? col * 9 + row : row * 9 + col;
+			grid[target] = labels[entry.puzzle[cell]];
+			expected[target] = labels[entry.solution[cell]];
+		}
+
+		const FuzzOutcome outcome = checkGrid(grid, withReference, failure);
+		if (outcome != FuzzOutcome::PASSED)
+		{
+			return outcome;
+		}
+		VariantSolver<ClassicRules> solver;
+		int solution[81];
+		if (!solver.setGrid(grid) || solver.countSolutions(2) != 1 || !solver.solve(solution) || !isSameGrid(solution, expected))
+		{
+			failure = "transformed puzzle lost its unique solution: " + gridText(grid);
+			return FuzzOutcome::FAILED;
+		}
+		return outcome;
+	}
+	else
+	{
+		// Adversarial grid, maybe with a clue removed
+		const char* text = gAdversarialGrids[random() % (sizeof(gAdversarialGrids) / sizeof(gAdversarialGrids[0]))];
+		for (int i = 0; i < 81; i++)
+		{
+			grid[i] = text[i] - '0';
+		}
+		if (random() & 1)
+		{
+			grid[random() % 81] = 0;
+		}
+	}
+	return checkGrid(grid, withReference, failure);
+}
+
+void Sudoku::DifferentialFuzzer::fail(const std::string& failure)
+{
+	std::lock_guard<std::mutex> lock(mFailureMutex);
+	if (mFailures++ == 0)
+	{
+		mFirstFailure = failure;
+	}
+	mStop = true;
+}
+
+bool Sudoku::DifferentialFuzzer::run(const int64_t cases, const int threads, const unsigned int seed)
+{
+	mCases = 0;
+	mSkipped = 0;
+	mFailures = 0;
+	mStop = false;
+	mFirstFailure.clear();
+
+	// Generate the pool mutated and transformed cases start from
+	mPool.resize(POOL_SIZE);
+	for (int i = 0; i < POOL_SIZE; i++)
+	{
+		Generator generator;
+		generator.setSeed(seed + (unsigned int)i);
+		generator.generate(mPool[i].puzzle, mPool[i].solution);
+	}
+
+	// Split the cases between threads, each with its own random numbers
+	const int totalThreads = threads > 0 ? threads : 1;
+	std::vector<std::thread> workers;
+	for (int thread = 0; thread < totalThreads; thread++)
+	{
+		const int64_t share = cases / totalThreads + (thread < cases % totalThreads ? 1 : 0);
+		workers.push_back(std::thread(&DifferentialFuzzer::runThread, this, share, seed * 31u + (unsigned int)thread + 1u));
+	}
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	return mFailures == 0;
+}
+
+int64_t Sudoku::DifferentialFuzzer::getCases() const
+{
+	return mCases;
+}
+
+int64_t Sudoku::DifferentialFuzzer::getSkipped() const
+{
+	return mSkipped;
+}
+
+int64_t Sudoku::DifferentialFuzzer::getFailures() const
+{
+	return mFailures;
+}
+
+const std::string& Sudoku::DifferentialFuzzer::getFirstFailure() const
+{
+	return mFirstFailure;
+}
+
+Sudoku::FuzzOutcome Sudoku::DifferentialFuzzer::checkGrid(const int* grid, const bool withReference, std::string& failure)
+{
+	// Every backend must reject conflicting givens the same way
+	const bool valid = isConflictFree(grid);
+	VariantSolver<ClassicRules> fast;
+	StepSolver<ClassicRules> step;
+	if (fast.setGrid(grid) != valid || step.setGrid(grid) != valid)
+	{
+		failure = "solvers disagree on conflicting givens: " + gridText(grid);
+		return FuzzOutcome::FAILED;
+	}
+	if (!valid)
+	{
+		return FuzzOutcome::PASSED;
+	}
+
+	// Bitmask solver counting up to two solutions, skipping grids it can't finish in time
+	const int solutions = fast.countSolutions(2, SolveLimits::budget(SOLVER_BUDGET / 1000.0));
+	if (fast.getStatus() == SolveStatus::TIMED_OUT)
+	{
+		return FuzzOutcome::SKIPPED;
+	}
+	int fastSolution[81] = { };
+	const bool fastSolved = solutions > 0 && fast.solve(fastSolution);
+
+	// Step solver run to the end
+	if (!step.step(STEP_NODE_LIMIT))
+	{
+		return FuzzOutcome::SKIPPED;
+	}
+	const bool stepSolved = step.getStatus() == SolveStatus::SOLVED;
+
+	// Solvability must agree, every solution must be valid, and a unique solution must be found by both
+	if (fastSolved != stepSolved)
+	{
+		failure = "bitmask and step solvers disagree on solvability: " + gridText(grid);
+		return FuzzOutcome::FAILED;
+	}
+	if (fastSolved && (!isSolutionOf(fastSolution, grid) || !isSolutionOf(step.getGrid(), grid)))
+	{
+		failure = "solver returned an invalid solution: " + gridText(grid);
+		return FuzzOutcome::FAILED;
+	}
+	if (solutions == 1 && !isSameGrid(fastSolution, step.getGrid()))
+	{
+		failure = "solvers found different solutions of a unique puzzle: " + gridText(grid);
+		return FuzzOutcome::FAILED;
+	}
+
+	// A hint on a unique puzzle must place the solution's number in an empty cell
+	if (solutions == 1)
+	{
+		const Hint hint = HintEngine::findHint(grid);
+		if (hint.index >= 0 && (grid[hint.index] != 0 || hint.num != fastSolution[hint.index]))
+		{
+			failure = "hint engine placed a wrong number: " + gridText(grid);
+			return FuzzOutcome::FAILED;
+		}
+	}
+
+	// Reference solver last, as it is the slowest by far
+	if (!withReference)
+	{
+		return FuzzOutcome::PASSED;
+	}
+	int reference[81];
+	for (int i = 0; i < 81; i++)
+	{
+		reference[i] = grid[i];
+	}
+	Solver solver;
+	solver.setGrid(reference);
+	const SolveStatus referenceStatus = solver.solve(SolveLimits::budget(REFERENCE_BUDGET / 1000.0));
+	if (referenceStatus == SolveStatus::TIMED_OUT)
+	{
+		return FuzzOutcome::SKIPPED;
+	}
+	const bool referenceSolved = referenceStatus == SolveStatus::SOLVED;
+	if (referenceSolved != fastSolved || (referenceSolved && !isSolutionOf(reference, grid)) || (solutions == 1 && !isSameGrid(reference, fastSolution)))
+	{
+		failure = "reference solver disagrees (reference " + std::to_string(referenceSolved) + ", bitmask " + std::to_string(fastSolved) + "): " + gridText(grid);
+		return FuzzOutcome::FAILED;
+	}
+	return FuzzOutcome::PASSED;
+}
+
+Sudoku::FuzzOutcome Sudoku::DifferentialFuzzer::checkGenerators(const unsigned int seed, std::string& failure)
+{
+	// The classic generator only keeps removals the reference solver proves don't open a second solution
+	Generator generator;
+	generator.setSeed(seed);
+	int puzzle[81];
+	int solution[81];
+	generator.generate(puzzle, solution);
+	VariantSolver<ClassicRules> solver;
+	int solved[81];
+	if (!solver.setGrid(puzzle) || solver.countSolutions(2) != 1 || !solver.solve(solved) || !isSameGrid(solved, solution) || !isSolutionOf(solution, puzzle))
+	{
+		failure = "classic generator made a puzzle without exactly one solution, seed " + std::to_string(seed) + ": " + gridText(puzzle);
+		return FuzzOutcome::FAILED;
+	}
+
+	FuzzOutcome outcome = checkGenerator<DiagonalRules>(seed, "diagonal", failure);
+	outcome = outcome == FuzzOutcome::PASSED ? checkGenerator<WindokuRules>(seed, "windoku", failure) : outcome;
+	outcome = outcome == FuzzOutcome::PASSED ? checkGenerator<KillerRules>(seed, "killer", failure) : outcome;
+	return outcome;
+}
+
+void Sudoku::DifferentialFuzzer::gridFromBytes(const uint8_t* data, const size_t size, int* grid)
+{
+	for (size_t i = 0; i < 81; i++)
+	{
+		grid[i] = i < size && data[i] >= '1' && data[i] <= '9' ? data[i] - '0' : 0;
+	}
+}
+
+#ifdef SUDOKU_FUZZER
+// libFuzzer entry point (build this file and the solver sources without main.cpp, with -fsanitize=fuzzer -DSUDOKU_FUZZER)
+// The first 81 bytes are the grid, so puzzle files make a good seed corpus; 4 more bytes are a generator seed
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	int grid[81];
+	std::string failure;
+	Sudoku::DifferentialFuzzer::gridFromBytes(data, size, grid);
+	Sudoku::FuzzOutcome outcome = Sudoku::DifferentialFuzzer::checkGrid(grid, true, failure);
+	if (outcome != Sudoku::FuzzOutcome::FAILED && size >= 85)
+	{
+		const unsigned int seed = (unsigned int)data[81] | ((unsigned int)data[82] << 8) | ((unsigned int)data[83] << 16) | ((unsigned int)data[84] << 24);
+		outcome = Sudoku::DifferentialFuzzer::checkGenerators(seed, failure);
+	}
+	if (outcome == Sudoku::FuzzOutcome::FAILED)
+	{
+		std::cerr << failure << std::endl;
+		abort();
+	}
+	return 0;
+}
+#endif
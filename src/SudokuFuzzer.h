@@ -0,0 +1,94 @@
+/* Differential fuzzing of the solvers, hint engine and generators against the reference solver */
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Sudoku
+{
+	// Result of checking one case (skipped cases were too hard for a backend to finish in time, so some checks were not made)
+	enum class FuzzOutcome
+	{
+		PASSED = 0,
+		SKIPPED = 1,
+		FAILED = 2
+	};
+
+	class DifferentialFuzzer
+	{
+	public:
+		// Time the bitmask solver gets per grid (microseconds); grids it can't finish in time are skipped
+		static const int SOLVER_BUDGET = 500;
+
+		// Placements the step solver gets per grid before the grid is skipped
+		static const int STEP_NODE_LIMIT = 1 << 16;
+
+		// Time the reference solver gets per grid (microseconds); the other checks still run on grids it can't finish in time
+		static const int REFERENCE_BUDGET = 500;
+
+		// Cases between reference solver checks (it takes most of the time of the cases it checks)
+		static const int REFERENCE_INTERVAL = 4;
+
+		// Cases between generator checks (generating is much slower than solving)
+		static const int GENERATOR_INTERVAL = 4096;
+
+		// Generated puzzles that mutated and transformed cases start from
+		static const int POOL_SIZE = 64;
+
+	private:
+		// Puzzle and solution cases are made from
+		struct PoolEntry
+		{
+			int puzzle[81];
+			int solution[81];
+		};
+		std::vector<PoolEntry> mPool;
+
+		// Cases run, skipped and failed across all threads, and whether to stop after a failure
+		std::atomic<int64_t> mCases;
+		std::atomic<int64_t> mSkipped;
+		std::atomic<int64_t> mFailures;
+		std::atomic<bool> mStop;
+
+		// Description of the first failure
+		std::mutex mFailureMutex;
+		std::string mFirstFailure;
+
+	private:
+		// Run cases on one thread until the total is reached or a case fails
+		void runThread(const int64_t total, const unsigned int seed);
+
+		// Make a random, mutated, transformed or adversarial case (transformed cases also check against their source)
+		FuzzOutcome runCase(std::minstd_rand& random, const bool withReference, std::string& failure) const;
+
+		// Record the first failure and stop every thread
+		void fail(const std::string& failure);
+
+	public:
+		// Constructor
+		DifferentialFuzzer();
+
+		// Run a number of cases on several threads from a seed, returning false if any case failed
+		bool run(const int64_t cases, const int threads, const unsigned int seed);
+
+		// Get cases run, skipped and failed by the last run, and the first failure
+		int64_t getCases() const;
+		int64_t getSkipped() const;
+		int64_t getFailures() const;
+		const std::string& getFirstFailure() const;
+
+		// Check one grid (0 for empty cells) with every solver backend and the hint engine, and against the reference solver if asked
+		static FuzzOutcome checkGrid(const int* grid, const bool withReference, std::string& failure);
+
+		// Check that every generator makes a unique puzzle that matches its solution for a seed
+		static FuzzOutcome checkGenerators(const unsigned int seed, std::string& failure);
+
+		// Make a grid from fuzzer bytes ('1' to '9' are numbers, anything else is empty, missing bytes are empty)
+		static void gridFromBytes(const uint8_t* data, const size_t size, int* grid);
+
+	};
+
+};
@@ -0,0 +1,149 @@
+#include "SudokuGenerationFarm.h"
+#include "SudokuGenerator.h"
+#include "SudokuPlatform.h"
+#include "SudokuPuzzleIO.h"
+#include <chrono>
+#include <thread>
+
+Sudoku::GenerationFarm::GenerationFarm()
+	: mNextSeed(0), mClaimed(0), mTotal(0)
+{
+
+}
+
+Sudoku::PuzzleFingerprint Sudoku::GenerationFarm::fingerprint(const int* grid)
+{
+	// Two independent 64-bit hashes of the cells
+	PuzzleFingerprint result;
+	result.low = 14695981039346656037ull;
+	result.high = 0x9E3779B97F4A7C15ull;
+	for (int i = 0; i < 81; i++)
+	{
+		result.low = (result.low ^ (uint64_t)grid[i]) * 1099511628211ull;
+		result.high = (result.high + (uint64_t)grid[i] + 1) * 0xBF58476D1CE4E5B9ull;
+		result.high ^= result.high >> 31;
+	}
+	return result;
+}
+
+bool Sudoku::GenerationFarm::insert(const PuzzleFingerprint& fingerprint)
+{
+	Stripe& stripe = mStripes[fingerprint.high % SET_STRIPES];
+	std::lock_guard<std::mutex> lock(stripe.mutex);
+	return stripe.fingerprints.insert(fingerprint).second;
+}
+
+void Sudoku::GenerationFarm::runShard(const int shard)
+{
+	ShardResult& result = mShards[shard];
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	PuzzleWriter writer;
+	if (!writer.open(result.path))
+	{
+		std::cerr << "Could not open " << result.path << std::endl;
+		return;
+	}
+
+	// Each thread has its own generator, so nothing is shared but the seed counter and the duplicate set
+	Generator generator;
+	int grid[81];
+	int solution[81];
+	while (mClaimed < mTotal)
+	{
+		const unsigned int seed = (unsigned int)mNextSeed++;
+		generator.setSeed(seed);
+		generator.generate(grid, solution);
+
+		if (!insert(fingerprint(grid)))
+		{
+			result.duplicates++;
+			continue;
+		}
+
+		// Another thread may have reached the total since the check above
+		if (mClaimed++ >= mTotal)
+		{
+			break;
+		}
+
+		char comment[32];
+		const int commentLength = snprintf(comment, sizeof(comment), "seed %u", seed);
+		writer.write(grid, comment, commentLength);
+		result.puzzles++;
+	}
+
+	if (!writer.close())
+	{
+		std::cerr << "Could not write " << result.path << std::endl;
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool Sudoku::GenerationFarm::run(const int64_t total, const int threads, const std::string& prefix, const unsigned int firstSeed)
+{
+	for (int i = 0; i < SET_STRIPES; i++)
+	{
+		mStripes[i].fingerprints.clear();
+	}
+	mNextSeed = firstSeed;
+	mClaimed = 0;
+	mTotal = total;
+
+	// One shard per thread
+	const int totalShards = threads > 0 ? threads : 1;
+	mShards.assign(totalShards, ShardResult());
+	for (int shard = 0; shard < totalShards; shard++)
+	{
+		char suffix[16];
+		snprintf(suffix, sizeof(suffix), "-%03d.txt", shard);
+		mShards[shard].path = prefix + suffix;
+	}
+
+	std::vector<std::thread> workers;
+	for (int shard = 0; shard < totalShards; shard++)
+	{
+		workers.push_back(std::thread(&GenerationFarm::runShard, this, shard));
+	}
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	int64_t written = 0;
+	for (int shard = 0; shard < totalShards; shard++)
+	{
+		written += mShards[shard].puzzles;
+	}
+	return written == total;
+}
+
+const std::vector<Sudoku::ShardResult>& Sudoku::GenerationFarm::getShards() const
+{
+	return mShards;
+}
+
+bool Sudoku::GenerationFarm::writeManifest(const std::string& path, const double seconds) const
+{
+	FILE* file = openFile(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	// One line per shard, then the totals
+	int64_t puzzles = 0;
+	int64_t duplicates = 0;
+	fprintf(file, "# shard puzzles duplicates seconds puzzles_per_second\n");
+	for (size_t i = 0; i < mShards.size(); i++)
+	{
+		const ShardResult& shard = mShards[i];
+		fprintf(file, "%s %lld %lld %.3f %.1f\n", shard.path.c_str(), (long long)shard.puzzles, (long long)shard.duplicates,
+			shard.seconds, shard.seconds > 0.0 ? shard.puzzles / shard.seconds : 0.0);
+		puzzles += shard.puzzles;
+		duplicates += shard.duplicates;
+	}
+	fprintf(file, "total %lld %lld %.3f %.1f\n", (long long)puzzles, (long long)duplicates, seconds, seconds > 0.0 ? puzzles / seconds : 0.0);
+
+	return fclose(file) == 0;
+}
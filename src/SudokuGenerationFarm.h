@@ -0,0 +1,94 @@
+/* Batch generation of unique Sudoku puzzles across threads into sharded output files */
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Sudoku
+{
+	// 128-bit fingerprint of a puzzle's cells (two puzzles are duplicates if their fingerprints match)
+	struct PuzzleFingerprint
+	{
+		uint64_t low = 0;
+		uint64_t high = 0;
+
+		bool operator==(const PuzzleFingerprint& other) const
+		{
+			return low == other.low && high == other.high;
+		}
+	};
+
+	struct PuzzleFingerprintHash
+	{
+		size_t operator()(const PuzzleFingerprint& fingerprint) const
+		{
+			return (size_t)(fingerprint.low ^ (fingerprint.high * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
+	// Results of one output shard (written by one thread)
+	struct ShardResult
+	{
+		std::string path;
+		int64_t puzzles = 0;
+		int64_t duplicates = 0;
+		double seconds = 0.0;
+	};
+
+	class GenerationFarm
+	{
+	public:
+		// Number of independently locked parts of the duplicate set
+		static const int SET_STRIPES = 64;
+
+	private:
+		// Part of the duplicate set with its own lock
+		struct Stripe
+		{
+			std::mutex mutex;
+			std::unordered_set<PuzzleFingerprint, PuzzleFingerprintHash> fingerprints;
+		};
+
+		// Duplicate set shared by all threads
+		Stripe mStripes[SET_STRIPES];
+
+		// Next seed to generate from, and number of unique puzzles claimed so far
+		std::atomic<uint64_t> mNextSeed;
+		std::atomic<int64_t> mClaimed;
+
+		// Number of unique puzzles to generate
+		int64_t mTotal;
+
+		// Results of every shard
+		std::vector<ShardResult> mShards;
+
+	private:
+		// Generate puzzles into one shard until the total is reached
+		void runShard(const int shard);
+
+		// Add a fingerprint to the duplicate set (returns false if it was already there)
+		bool insert(const PuzzleFingerprint& fingerprint);
+
+	public:
+		// Constructor
+		GenerationFarm();
+
+		// Generate unique puzzles on a number of threads, each writing its own file "<prefix>-<shard>.txt"
+		// Seeds are taken in order from firstSeed and written after each puzzle, so any puzzle can be generated again
+		bool run(const int64_t total, const int threads, const std::string& prefix, const unsigned int firstSeed);
+
+		// Get results of every shard of the last run
+		const std::vector<ShardResult>& getShards() const;
+
+		// Write per-shard counts and timing to a manifest file
+		bool writeManifest(const std::string& path, const double seconds) const;
+
+		// Fingerprint of a puzzle's 81 cells
+		static PuzzleFingerprint fingerprint(const int* grid);
+
+	};
+
+};
@@ -1,11 +1,16 @@
 #include "SudokuGenerator.h"
 
 Sudoku::Generator::Generator()
-	: mGrid(nullptr), mGridSolution(nullptr)
+	: mGrid(nullptr), mGridSolution(nullptr), mSeed((unsigned int)time(NULL))
 {
 
 }
 
+inline int Sudoku::Generator::random(const int range)
+{
+	return (int)(mRandom() % (unsigned int)range);
+}
+
 inline void Sudoku::Generator::setElement(const int row, const int col, const int num)
 {
 	mGrid[row * 9 + col] = num;
@@ -85,8 +90,8 @@ void Sudoku::Generator::copyGrid(int* grid) const
 
 void Sudoku::Generator::createCompletedSudoku()
 {
-	// Set random seed using time
-	srand((unsigned int)time(NULL));
+	// Set random seed
+	mRandom.seed(mSeed);
 
 	// 1. Fill first row with numbers 1 to 9
 	for (int i = 0; i < 9; i++)
@@ -98,8 +103,8 @@ void Sudoku::Generator::createCompletedSudoku()
 	int swaps = 50;
 	for (int i = 0; i < swaps; i++)
 	{
-		int randIndex1 = rand() % 9;
-		int randIndex2 = rand() % 9;
+		int randIndex1 = random(9);
+		int randIndex2 = random(9);
 		if (randIndex1 != randIndex2)
 		{
 			swapNumbers(randIndex1, randIndex2);
@@ -130,8 +135,8 @@ void Sudoku::Generator::createCompletedSudoku()
 	{
 		for (int shuffle = 0; shuffle < shuffles; shuffle++)
 		{
-			int randRow1 = rowBlock * 3 + (rand() % 3);
-			int randRow2 = rowBlock * 3 + (rand() % 3);
+			int randRow1 = rowBlock * 3 + random(3);
+			int randRow2 = rowBlock * 3 + random(3);
 			if (randRow1 != randRow2)
 			{
 				swapRows(randRow1, randRow2);
@@ -144,8 +149,8 @@ void Sudoku::Generator::createCompletedSudoku()
 	{
 		for (int shuffle = 0; shuffle < shuffles; shuffle++)
 		{
-			int randCol1 = colBlock * 3 + (rand() % 3);
-			int randCol2 = colBlock * 3 + (rand() % 3);
+			int randCol1 = colBlock * 3 + random(3);
+			int randCol2 = colBlock * 3 + random(3);
 			if (randCol1 != randCol2)
 			{
 				swapCols(randCol1, randCol2);
@@ -156,8 +161,8 @@ void Sudoku::Generator::createCompletedSudoku()
 	// 10. Shuffle row blocks
 	for (int shuffle = 0; shuffle < shuffles; shuffle++)
 	{
-		int randRowBlock1 = rand() % 3;
-		int randRowBlock2 = rand() % 3;
+		int randRowBlock1 = random(3);
+		int randRowBlock2 = random(3);
 		if (randRowBlock1 != randRowBlock2)
 		{
 			swapRowBlocks(randRowBlock1, randRowBlock2);
@@ -167,8 +172,8 @@ void Sudoku::Generator::createCompletedSudoku()
 	// 11. Shuffle col blocks
 	for (int shuffle = 0; shuffle < shuffles; shuffle++)
 	{
-		int randColBlock1 = rand() % 3;
-		int randColBlock2 = rand() % 3;
+		int randColBlock1 = random(3);
+		int randColBlock2 = random(3);
 		if (randColBlock1 != randColBlock2)
 		{
 			swapColBlocks(randColBlock1, randColBlock2);
@@ -180,7 +185,22 @@ void Sudoku::Generator::createCompletedSudoku()
 
 }
 
+void Sudoku::Generator::setSeed(const unsigned int seed)
+{
+	mSeed = seed;
+}
+
+unsigned int Sudoku::Generator::getSeed() const
+{
+	return mSeed;
+}
+
 void Sudoku::Generator::generate(int* grid, int* solutionGrid)
+{
+	generate(grid, solutionGrid, SolveLimits());
+}
+
+Sudoku::SolveStatus Sudoku::Generator::generate(int* grid, int* solutionGrid, const SolveLimits& limits)
 {
 	// Set the Sudoku grid and solution grid
 	mGrid = grid;
@@ -189,8 +209,8 @@ void Sudoku::Generator::generate(int* grid, int* solutionGrid)
 	// Create completed Sudoku
 	createCompletedSudoku();
 
-	// Set random seed using time
-	srand((unsigned int)time(NULL));
+	// Set random seed
+	mRandom.seed(mSeed);
 
 	// Create Sudoku solver object
 	Solver SS;
@@ -198,8 +218,9 @@ void Sudoku::Generator::generate(int* grid, int* solutionGrid)
 	// Set the Sudoku solver to have the generator modifier
 	SS.setGenModifier(true);
 
-	// Create grid of bool types to track if elements have been removed from the main grid
-	bool removed[81] = { };
+	// Create grid of bool types to track if elements have been tried for removal (a number that can't be removed never can be later)
+	bool tried[81] = { };
+	int untried = 81;
 
 	// Create a temporary duplicate grid
 	int duplicateGrid[81];
@@ -210,12 +231,16 @@ void Sudoku::Generator::generate(int* grid, int* solutionGrid)
 	// Elements to remove
 	int toRemove = 50;
 
-	while (toRemove)
+	// Aggregate solver statistics over this call
+	SUDOKU_STAT(mStats.reset());
+
+	// Stop early if every number was tried, so a grid with fewer removable numbers still finishes
+	while (toRemove && untried)
 	{
 		// 1. Pick a random number you haven't tried removing before
-		int randRow = rand() % 9;
-		int randCol = rand() % 9;
-		if (!removed[randRow * 9 + randCol])
+		int randRow = random(9);
+		int randCol = random(9);
+		if (!tried[randRow * 9 + randCol])
 		{
 			// 2. Remove the number, then run solver without the number to be determined to be removed
 			removingNumber = getElement(randRow, randCol);
@@ -225,16 +250,29 @@ void Sudoku::Generator::generate(int* grid, int* solutionGrid)
 			SS.setGrid(duplicateGrid, numToIgnore);
 
 			// 3. If the solver does not find a solution, then remove number
-			if (!SS.solve())
+			const SolveStatus status = SS.solve(limits);
+			SUDOKU_STAT(mStats.add(SS.getStats()));
+			if (status == SolveStatus::CANCELLED || status == SolveStatus::TIMED_OUT)
+			{
+				return status;
+			}
+			if (status == SolveStatus::NO_SOLUTION)
 			{
 				setElement(randRow, randCol, 0);
-				removed[randRow * 9 + randCol] = true;
 				toRemove--;
 			}
+			tried[randRow * 9 + randCol] = true;
+			untried--;
 		}
 		// 4. Repeat, until enough numbers removed
 	}
 
+	return SolveStatus::SOLVED;
+}
+
+const Sudoku::SolverStats& Sudoku::Generator::getStats() const
+{
+	return mStats;
 }
 
 void Sudoku::Generator::display() const
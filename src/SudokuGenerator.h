@@ -1,7 +1,7 @@
 /* Sudoku generator class */
 #pragma once
 #include <iostream>
-#include <stdlib.h>
+#include <random>
 #include <time.h>
 #include "SudokuSolver.h"
 
@@ -16,7 +16,19 @@ namespace Sudoku
 		// Sudoku solution 1D array and must be of size 9 x 9 = 81
 		int* mGridSolution;
 
+		// Solver statistics aggregated over the last generate call
+		SolverStats mStats;
+
+		// Random seed (the same seed generates the same Sudoku)
+		unsigned int mSeed;
+
+		// Random number generator owned by this generator, so generators on different threads don't share state
+		std::minstd_rand mRandom;
+
 	private:
+		// Get random number from 0 to range - 1
+		inline int random(const int range);
+
 		// Set and get element of 1D array using row and col
 		inline void setElement(const int row, const int col, const int num);
 		inline int getElement(const int row, const int col) const;
@@ -41,9 +53,19 @@ namespace Sudoku
 		// Constructor for intialisation
 		Generator();
 
+		// Set and get random seed (defaults to the current time)
+		void setSeed(const unsigned int seed);
+		unsigned int getSeed() const;
+
 		// Generate Sudoku from completed Sudoku and return a pointer to it
 		void generate(int* grid, int* solutionGrid);
 
+		// Generate Sudoku until cancelled or past the deadline (grid holds the cells removed so far if stopped)
+		SolveStatus generate(int* grid, int* solutionGrid, const SolveLimits& limits);
+
+		// Get solver statistics aggregated over the last generate call, partial if it was stopped (all zero unless SUDOKU_SOLVER_STATS is defined)
+		const SolverStats& getStats() const;
+
 		// Display Sudoku to console (for debugging)
 		void display() const;
 
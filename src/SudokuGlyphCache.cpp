@@ -0,0 +1,326 @@
+#include "SudokuGlyphCache.h"
+
+Sudoku::GlyphCache::GlyphCache()
+	: mRenderer(nullptr),
+	  mAssets(nullptr), mFontName(nullptr), mStrings(nullptr), mTotalStrings(0), mCriticalStrings(0),
+	  mActive(nullptr),
+	  mPendingSize(0), mPendingSince(0)
+{
+
+}
+
+Sudoku::GlyphCache::~GlyphCache()
+{
+	free();
+}
+
+TTF_Font* Sudoku::GlyphCache::openFont(const int fontSize) const
+{
+	// Each size reads the same font data (mapped from the archive, so nothing is copied)
+	SDL_RWops* file = mAssets->openRW(mFontName);
+	return file != nullptr ? TTF_OpenFontRW(file, 1, fontSize) : nullptr;
+}
+
+bool Sudoku::GlyphCache::rasterize(Entry& entry, const int fontSize)
+{
+	// Open font at the requested pixel size
+	entry.font = openFont(fontSize);
+	if (entry.font == nullptr)
+	{
+		std::cout << "Failed to load font! Error: " << TTF_GetError() << std::endl;
+		return false;
+	}
+	entry.fontSize = fontSize;
+	entry.nextString = 0;
+
+	// Strings needed for the first frame
+	while (entry.nextString < mCriticalStrings)
+	{
+		rasterizeNext(entry);
+	}
+	return true;
+}
+
+void Sudoku::GlyphCache::rasterizeNext(Entry& entry)
+{
+	const int total = mTotalStrings < MAX_TEXTURES ? mTotalStrings : MAX_TEXTURES;
+	const int i = entry.nextString++;
+	if (i == total)
+	{
+		rasterizeAtlas(entry, entry.fontSize);
+		return;
+	}
+	if (i > total || mStrings[i] == nullptr)
+	{
+		return;
+	}
+
+	// Choose colour of font
+	SDL_Color fontColour = { 0, 0, 0, SDL_ALPHA_OPAQUE }; // black
+
+	// Create text surface
+	SDL_Surface* textSurface = TTF_RenderText_Solid(entry.font, mStrings[i], fontColour);
+	if (textSurface == nullptr)
+	{
+		std::cout << "Could not create TTF SDL_Surface! Error: " << TTF_GetError() << std::endl;
+		return;
+	}
+
+	// Create texture from surface pixels
+	entry.textures[i] = SDL_CreateTextureFromSurface(mRenderer, textSurface);
+	if (entry.textures[i] == nullptr)
+	{
+		std::cout << "Could not create texture from surface! Error: " << SDL_GetError() << std::endl;
+	}
+	SDL_FreeSurface(textSurface);
+}
+
+void Sudoku::GlyphCache::rasterizeAtlas(Entry& entry, const int fontSize)
+{
+	// Pencil marks are a third of the size of the numbers
+	const int smallSize = fontSize / 3 > 6 ? fontSize / 3 : 6;
+	TTF_Font* smallFont = openFont(smallSize);
+	if (smallFont == nullptr)
+	{
+		std::cout << "Failed to load font! Error: " << TTF_GetError() << std::endl;
+		return;
+	}
+
+	// Render digits
+	SDL_Color fontColour = { 60, 60, 60, SDL_ALPHA_OPAQUE }; // dark grey
+	SDL_Surface* digitSurfaces[10] = { nullptr };
+	int cellWidth = 0;
+	int cellHeight = 0;
+	for (int num = 1; num <= 9; num++)
+	{
+		const char text[] = { (char)('0' + num), '\0' };
+		digitSurfaces[num] = TTF_RenderText_Blended(smallFont, text, fontColour);
+		if (digitSurfaces[num] != nullptr)
+		{
+			cellWidth = digitSurfaces[num]->w > cellWidth ? digitSurfaces[num]->w : cellWidth;
+			cellHeight = digitSurfaces[num]->h > cellHeight ? digitSurfaces[num]->h : cellHeight;
+		}
+	}
+	TTF_CloseFont(smallFont);
+
+	// Copy digits side by side into one transparent surface
+	SDL_Surface* atlasSurface = cellWidth > 0 ? SDL_CreateRGBSurfaceWithFormat(0, 9 * cellWidth, cellHeight, 32, SDL_PIXELFORMAT_ARGB8888) : nullptr;
+	if (atlasSurface != nullptr)
+	{
+		SDL_FillRect(atlasSurface, nullptr, SDL_MapRGBA(atlasSurface->format, 0, 0, 0, 0));
+	}
+	for (int num = 1; num <= 9; num++)
+	{
+		if (digitSurfaces[num] == nullptr)
+		{
+			continue;
+		}
+		SDL_Rect rect = { (num - 1) * cellWidth, 0, digitSurfaces[num]->w, digitSurfaces[num]->h };
+		entry.atlasRects[num] = rect;
+		if (atlasSurface != nullptr)
+		{
+			SDL_SetSurfaceBlendMode(digitSurfaces[num], SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(digitSurfaces[num], nullptr, atlasSurface, &rect);
+		}
+		SDL_FreeSurface(digitSurfaces[num]);
+	}
+
+	if (atlasSurface != nullptr)
+	{
+		entry.atlas = SDL_CreateTextureFromSurface(mRenderer, atlasSurface);
+		if (entry.atlas == nullptr)
+		{
+			std::cout << "Could not create texture from surface! Error: " << SDL_GetError() << std::endl;
+		}
+		else
+		{
+			SDL_SetTextureBlendMode(entry.atlas, SDL_BLENDMODE_BLEND);
+			entry.atlasWidth = atlasSurface->w;
+			entry.atlasHeight = atlasSurface->h;
+		}
+		SDL_FreeSurface(atlasSurface);
+	}
+}
+
+void Sudoku::GlyphCache::freeEntry(Entry& entry)
+{
+	for (int i = 0; i < MAX_TEXTURES; i++)
+	{
+		// Free texture if it exists
+		if (entry.textures[i] != nullptr)
+		{
+			SDL_DestroyTexture(entry.textures[i]);
+			entry.textures[i] = nullptr;
+		}
+	}
+
+	if (entry.atlas != nullptr)
+	{
+		SDL_DestroyTexture(entry.atlas);
+		entry.atlas = nullptr;
+	}
+	entry.atlasWidth = 0;
+	entry.atlasHeight = 0;
+
+	if (entry.font != nullptr)
+	{
+		TTF_CloseFont(entry.font);
+		entry.font = nullptr;
+	}
+	entry.fontSize = 0;
+	entry.lastUsed = 0;
+	entry.nextString = 0;
+}
+
+Sudoku::GlyphCache::Entry* Sudoku::GlyphCache::findEntry(const int fontSize)
+{
+	for (int i = 0; i < MAX_SIZES; i++)
+	{
+		if (mEntries[i].fontSize == fontSize)
+		{
+			return &mEntries[i];
+		}
+	}
+	return nullptr;
+}
+
+bool Sudoku::GlyphCache::activate(const int fontSize, const Uint32 now)
+{
+	Entry* entry = findEntry(fontSize);
+
+	if (entry == nullptr)
+	{
+		// Reuse an empty slot or evict the least recently used size (never the active one)
+		for (int i = 0; i < MAX_SIZES; i++)
+		{
+			if (&mEntries[i] == mActive)
+			{
+				continue;
+			}
+			if (entry == nullptr || mEntries[i].lastUsed < entry->lastUsed)
+			{
+				entry = &mEntries[i];
+			}
+		}
+		freeEntry(*entry);
+
+		if (!rasterize(*entry, fontSize))
+		{
+			freeEntry(*entry);
+			return false;
+		}
+	}
+
+	entry->lastUsed = now;
+	mActive = entry;
+	return true;
+}
+
+void Sudoku::GlyphCache::initialise(SDL_Renderer* renderer, const AssetArchive* assets, const char* fontName, const char* const* strings, const int totalStrings, const int criticalStrings)
+{
+	free();
+	mRenderer = renderer;
+	mAssets = assets;
+	mFontName = fontName;
+	mStrings = strings;
+	mTotalStrings = totalStrings;
+	mCriticalStrings = criticalStrings < totalStrings ? criticalStrings : totalStrings;
+}
+
+bool Sudoku::GlyphCache::setSize(const int fontSize)
+{
+	mPendingSize = 0;
+	return activate(fontSize, SDL_GetTicks());
+}
+
+bool Sudoku::GlyphCache::requestSize(const int fontSize, const Uint32 now)
+{
+	// Nothing to do if the size is already in use
+	if (mActive != nullptr && mActive->fontSize == fontSize)
+	{
+		mPendingSize = 0;
+		return false;
+	}
+
+	// Cached sizes can be used straight away
+	if (findEntry(fontSize) != nullptr)
+	{
+		mPendingSize = 0;
+		return activate(fontSize, now);
+	}
+
+	// Otherwise wait until the size stops changing (e.g. the user is still dragging the window edge)
+	mPendingSize = fontSize;
+	mPendingSince = now;
+	return false;
+}
+
+bool Sudoku::GlyphCache::update(const Uint32 now)
+{
+	if (mPendingSize != 0 && now - mPendingSince >= SETTLE_TIME)
+	{
+		const int fontSize = mPendingSize;
+		mPendingSize = 0;
+		return activate(fontSize, now);
+	}
+
+	// Spread deferred strings of the active size over several updates
+	if (mActive != nullptr && !isComplete())
+	{
+		for (int i = 0; i < DEFERRED_PER_UPDATE && !isComplete(); i++)
+		{
+			rasterizeNext(*mActive);
+		}
+		return true;
+	}
+	return false;
+}
+
+bool Sudoku::GlyphCache::isComplete() const
+{
+	// The atlas comes after the last string
+	const int total = mTotalStrings < MAX_TEXTURES ? mTotalStrings : MAX_TEXTURES;
+	return mActive == nullptr || mActive->nextString > total;
+}
+
+SDL_Texture** Sudoku::GlyphCache::getTextures()
+{
+	// Fall back to an empty set so callers can always index the textures
+	return mActive != nullptr ? mActive->textures : mEntries[0].textures;
+}
+
+TTF_Font* Sudoku::GlyphCache::getFont() const
+{
+	return mActive != nullptr ? mActive->font : nullptr;
+}
+
+int Sudoku::GlyphCache::getFontSize() const
+{
+	return mActive != nullptr ? mActive->fontSize : 0;
+}
+
+SDL_Texture* Sudoku::GlyphCache::getAtlas() const
+{
+	return mActive != nullptr ? mActive->atlas : nullptr;
+}
+
+void Sudoku::GlyphCache::getAtlasSize(int& width, int& height) const
+{
+	width = mActive != nullptr ? mActive->atlasWidth : 0;
+	height = mActive != nullptr ? mActive->atlasHeight : 0;
+}
+
+const SDL_Rect& Sudoku::GlyphCache::getAtlasRect(const int num) const
+{
+	return mActive != nullptr ? mActive->atlasRects[num] : mEntries[0].atlasRects[num];
+}
+
+void Sudoku::GlyphCache::free()
+{
+	for (int i = 0; i < MAX_SIZES; i++)
+	{
+		freeEntry(mEntries[i]);
+	}
+	mActive = nullptr;
+	mPendingSize = 0;
+}
@@ -0,0 +1,123 @@
+/* Glyph cache holding text textures rasterized at the most recently used font sizes */
+#pragma once
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <iostream>
+#include "SudokuAssetArchive.h"
+
+namespace Sudoku
+{
+	class GlyphCache
+	{
+	public:
+		// Maximum number of textures per font size
+		static const int MAX_TEXTURES = 48;
+
+		// Number of font sizes kept before the least recently used one is evicted
+		static const int MAX_SIZES = 3;
+
+		// Time a requested size must stay unchanged before it is rasterized (milliseconds)
+		static const Uint32 SETTLE_TIME = 150;
+
+		// Deferred strings rasterized per update, so a frame is never held up by more than a few of them
+		static const int DEFERRED_PER_UPDATE = 4;
+
+	private:
+		// Font and textures rasterized at one pixel size
+		struct Entry
+		{
+			int fontSize = 0;
+			TTF_Font* font = nullptr;
+			SDL_Texture* textures[MAX_TEXTURES] = { nullptr };
+			Uint32 lastUsed = 0;
+
+			// Strings before this index have been rasterized (the atlas is rasterized after the last string)
+			int nextString = 0;
+
+			// Atlas of small digits 1 to 9 for pencil marks, with the source rect of each digit
+			SDL_Texture* atlas = nullptr;
+			SDL_Rect atlasRects[10] = { };
+			int atlasWidth = 0;
+			int atlasHeight = 0;
+		};
+
+		// Renderer used to create textures
+		SDL_Renderer* mRenderer;
+
+		// Assets holding the true type font, its name and the strings to rasterize (nullptr entries are skipped)
+		const AssetArchive* mAssets;
+		const char* mFontName;
+		const char* const* mStrings;
+		int mTotalStrings;
+
+		// Strings rasterized as soon as a size is activated; the rest are deferred to later updates
+		int mCriticalStrings;
+
+		// Cached sizes and the one currently in use
+		Entry mEntries[MAX_SIZES];
+		Entry* mActive;
+
+		// Size waiting to settle before it is rasterized
+		int mPendingSize;
+		Uint32 mPendingSince;
+
+	private:
+		// Open font at a pixel size from the assets
+		TTF_Font* openFont(const int fontSize) const;
+
+		// Open font at a font size and rasterize the critical strings into an entry
+		bool rasterize(Entry& entry, const int fontSize);
+
+		// Rasterize the next string of an entry (or the atlas after the last string)
+		void rasterizeNext(Entry& entry);
+
+		// Rasterize small digits into a single atlas texture
+		void rasterizeAtlas(Entry& entry, const int fontSize);
+
+		// Free font and textures of an entry
+		void freeEntry(Entry& entry);
+
+		// Find a cached entry by font size
+		Entry* findEntry(const int fontSize);
+
+		// Make an entry active, rasterizing into the least recently used slot if needed
+		bool activate(const int fontSize, const Uint32 now);
+
+	public:
+		// Constructor
+		GlyphCache();
+
+		// Destructor to free fonts and textures
+		~GlyphCache();
+
+		// Set renderer, font and strings to rasterize (strings from criticalStrings onwards are rasterized by later updates)
+		void initialise(SDL_Renderer* renderer, const AssetArchive* assets, const char* fontName, const char* const* strings, const int totalStrings, const int criticalStrings);
+
+		// Rasterize a font size straight away (used at start up)
+		bool setSize(const int fontSize);
+
+		// Request a new font size; cached sizes switch immediately (returns true), others wait to settle
+		bool requestSize(const int fontSize, const Uint32 now);
+
+		// Rasterize a settled pending size or some deferred strings and return true if the active textures changed
+		bool update(const Uint32 now);
+
+		// Check if every string of the active size has been rasterized
+		bool isComplete() const;
+
+		// Get active textures and font
+		SDL_Texture** getTextures();
+		TTF_Font* getFont() const;
+		int getFontSize() const;
+
+		// Get small digit atlas, its size, and the source rect of a digit (1 to 9)
+		SDL_Texture* getAtlas() const;
+		void getAtlasSize(int& width, int& height) const;
+		const SDL_Rect& getAtlasRect(const int num) const;
+
+		// Free all fonts and textures
+		void free();
+
+	};
+
+};
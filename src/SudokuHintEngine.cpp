@@ -0,0 +1,384 @@
+#include "SudokuHintEngine.h"
+
+namespace
+{
+	// Mask with all 9 candidate bits set (bit 0 = number 1)
+	const unsigned int ALL_CANDIDATES = 0x1FF;
+
+	// Cells of the 27 units: rows, then cols, then 3 x 3 blocks
+	struct Units
+	{
+		int cells[27][9];
+
+		Units()
+		{
+			for (int unit = 0; unit < 9; unit++)
+			{
+				for (int i = 0; i < 9; i++)
+				{
+					cells[unit][i] = unit * 9 + i;
+					cells[9 + unit][i] = i * 9 + unit;
+					cells[18 + unit][i] = ((unit / 3) * 3 + i / 3) * 9 + (unit % 3) * 3 + i % 3;
+				}
+			}
+		}
+	};
+	const Units gUnits;
+
+	// Count candidate bits
+	inline int countBits(unsigned int mask)
+	{
+		int count = 0;
+		while (mask)
+		{
+			mask &= mask - 1;
+			count++;
+		}
+		return count;
+	}
+
+	// Number of the lowest candidate bit
+	inline int lowestNumber(const unsigned int mask)
+	{
+		int num = 1;
+		while (!(mask & (1u << (num - 1))))
+		{
+			num++;
+		}
+		return num;
+	}
+
+	inline int getBlock(const int index)
+	{
+		return (index / 27) * 3 + (index % 9) / 3;
+	}
+
+	// Remove a candidate from cells of a unit that are not in the excluded unit, returning true if any changed
+	bool eliminate(unsigned int* candidates, const int unit, const unsigned int bit, const int excludedUnit)
+	{
+		bool changed = false;
+		for (int i = 0; i < 9; i++)
+		{
+			const int cell = gUnits.cells[unit][i];
+			const bool excluded = excludedUnit < 9 ? cell / 9 == excludedUnit
+				: excludedUnit < 18 ? cell % 9 == excludedUnit - 9
+				: getBlock(cell) == excludedUnit - 18;
+			if (!excluded && (candidates[cell] & bit))
+			{
+				candidates[cell] &= ~bit;
+				changed = true;
+			}
+		}
+		return changed;
+	}
+
+	// Pointing and claiming: a number confined to the intersection of two units is removed from the rest of both
+	bool applyLockedCandidates(unsigned int* candidates)
+	{
+		bool changed = false;
+		for (int unit = 0; unit < 27; unit++)
+		{
+			for (int num = 1; num <= 9; num++)
+			{
+				const unsigned int bit = 1u << (num - 1);
+				int rows = 0;
+				int cols = 0;
+				int blocks = 0;
+				int found = 0;
+				int row = -1;
+				int col = -1;
+				int block = -1;
+				for (int i = 0; i < 9; i++)
+				{
+					const int cell = gUnits.cells[unit][i];
+					if (candidates[cell] & bit)
+					{
+						if (cell / 9 != row) { row = cell / 9; rows++; }
+						if (cell % 9 != col) { col = cell % 9; cols++; }
+						if (getBlock(cell) != block) { block = getBlock(cell); blocks++; }
+						found++;
+					}
+				}
+				if (found < 2)
+				{
+					continue;
+				}
+
+				// Block confined to one row or col (pointing)
+				if (unit >= 18)
+				{
+					if (rows == 1) changed |= eliminate(candidates, row, bit, unit);
+					if (cols == 1) changed |= eliminate(candidates, 9 + col, bit, unit);
+				}
+				// Row or col confined to one block (claiming)
+				else if (blocks == 1)
+				{
+					changed |= eliminate(candidates, 18 + block, bit, unit);
+				}
+			}
+		}
+		return changed;
+	}
+
+	// Two cells of a unit with the same two candidates remove them from the rest of the unit
+	bool applyNakedPairs(unsigned int* candidates, const int* grid)
+	{
+		bool changed = false;
+		for (int unit = 0; unit < 27; unit++)
+		{
+			for (int i = 0; i < 9; i++)
+			{
+				const int first = gUnits.cells[unit][i];
+				if (grid[first] != 0 || countBits(candidates[first]) != 2)
+				{
+					continue;
+				}
+				for (int j = i + 1; j < 9; j++)
+				{
+					const int second = gUnits.cells[unit][j];
+					if (grid[second] != 0 || candidates[second] != candidates[first])
+					{
+						continue;
+					}
+					for (int k = 0; k < 9; k++)
+					{
+						const int cell = gUnits.cells[unit][k];
+						if (cell != first && cell != second && grid[cell] == 0 && (candidates[cell] & candidates[first]))
+						{
+							candidates[cell] &= ~candidates[first];
+							changed = true;
+						}
+					}
+				}
+			}
+		}
+		return changed;
+	}
+}
+
+Sudoku::Hint Sudoku::HintEngine::findHint(const int* grid, const std::atomic<unsigned int>* generation, const unsigned int requestGeneration)
+{
+	Hint hint;
+
+	// Build row, col and block masks of placed numbers
+	unsigned int rowMask[9] = { };
+	unsigned int colMask[9] = { };
+	unsigned int blockMask[9] = { };
+	for (int cell = 0; cell < 81; cell++)
+	{
+		if (grid[cell] != 0)
+		{
+			const unsigned int bit = 1u << (grid[cell] - 1);
+			if ((rowMask[cell / 9] | colMask[cell % 9] | blockMask[getBlock(cell)]) & bit)
+			{
+				// Repeated number, nothing can be deduced
+				return hint;
+			}
+			rowMask[cell / 9] |= bit;
+			colMask[cell % 9] |= bit;
+			blockMask[getBlock(cell)] |= bit;
+		}
+	}
+
+	// Candidates of each empty cell
+	unsigned int candidates[81];
+	for (int cell = 0; cell < 81; cell++)
+	{
+		candidates[cell] = 0;
+		if (grid[cell] == 0)
+		{
+			candidates[cell] = ALL_CANDIDATES & ~(rowMask[cell / 9] | colMask[cell % 9] | blockMask[getBlock(cell)]);
+			if (candidates[cell] == 0)
+			{
+				// Contradiction, the board has a mistake
+				return hint;
+			}
+		}
+	}
+
+	// Hardest elimination technique applied so far
+	HintTechnique eliminations = HintTechnique::NONE;
+
+	while (true)
+	{
+		// Give up if a newer request arrived
+		if (generation != nullptr && generation->load(std::memory_order_relaxed) != requestGeneration)
+		{
+			return Hint();
+		}
+
+		// Naked single: a cell with one candidate
+		for (int cell = 0; cell < 81; cell++)
+		{
+			if (grid[cell] == 0 && countBits(candidates[cell]) == 1)
+			{
+				hint.index = cell;
+				hint.num = lowestNumber(candidates[cell]);
+				hint.technique = eliminations != HintTechnique::NONE ? eliminations : HintTechnique::NAKED_SINGLE;
+				return hint;
+			}
+		}
+
+		// Hidden single: a number with one place in a block, row or col (blocks first, as players look there first)
+		for (int unitIndex = 0; unitIndex < 27; unitIndex++)
+		{
+			const int unit = (unitIndex + 18) % 27;
+			for (int num = 1; num <= 9; num++)
+			{
+				const unsigned int bit = 1u << (num - 1);
+				int found = 0;
+				int place = -1;
+				for (int i = 0; i < 9 && found < 2; i++)
+				{
+					const int cell = gUnits.cells[unit][i];
+					if (grid[cell] == num)
+					{
+						found = 2;
+					}
+					else if (candidates[cell] & bit)
+					{
+						place = cell;
+						found++;
+					}
+				}
+				if (found == 1)
+				{
+					hint.index = place;
+					hint.num = num;
+					hint.technique = eliminations != HintTechnique::NONE ? eliminations : HintTechnique::HIDDEN_SINGLE;
+					return hint;
+				}
+			}
+		}
+
+		// Remove candidates and try singles again
+		if (applyLockedCandidates(candidates))
+		{
+			if (eliminations == HintTechnique::NONE)
+			{
+				eliminations = HintTechnique::LOCKED_CANDIDATES;
+			}
+		}
+		else if (applyNakedPairs(candidates, grid))
+		{
+			eliminations = HintTechnique::NAKED_PAIR;
+		}
+		else
+		{
+			// Nothing more can be deduced with these techniques
+			return hint;
+		}
+	}
+}
+
+Sudoku::HintEngine::HintEngine()
+	: mStop(false),
+	  mRequestGrid{ },
+	  mHasRequest(false),
+	  mHasResult(false),
+	  mGeneration(0)
+{
+
+}
+
+Sudoku::HintEngine::~HintEngine()
+{
+	stop();
+}
+
+void Sudoku::HintEngine::start()
+{
+	if (!mWorker.joinable())
+	{
+		mStop = false;
+		mWorker = std::thread(&HintEngine::run, this);
+	}
+}
+
+void Sudoku::HintEngine::stop()
+{
+	if (mWorker.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStop = true;
+		}
+		mGeneration++;
+		mCondition.notify_one();
+		mWorker.join();
+	}
+}
+
+void Sudoku::HintEngine::request(const int* grid)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (int i = 0; i < 81; i++)
+		{
+			mRequestGrid[i] = grid[i];
+		}
+		mHasRequest = true;
+		mHasResult = false;
+		mGeneration++;
+	}
+	mCondition.notify_one();
+}
+
+void Sudoku::HintEngine::cancel()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mHasRequest = false;
+	mHasResult = false;
+	mGeneration++;
+}
+
+bool Sudoku::HintEngine::poll(Hint& hint)
+{
+	// Never wait for the worker, try again next frame instead
+	std::unique_lock<std::mutex> lock(mMutex, std::try_to_lock);
+	if (!lock.owns_lock() || !mHasResult)
+	{
+		return false;
+	}
+
+	hint = mResult;
+	mHasResult = false;
+	return true;
+}
+
+void Sudoku::HintEngine::run()
+{
+	int grid[81];
+
+	while (true)
+	{
+		unsigned int requestGeneration;
+		{
+			// Wait for a request
+			std::unique_lock<std::mutex> lock(mMutex);
+			mCondition.wait(lock, [this] { return mStop || mHasRequest; });
+			if (mStop)
+			{
+				return;
+			}
+
+			// Take a copy so the board can keep changing
+			for (int i = 0; i < 81; i++)
+			{
+				grid[i] = mRequestGrid[i];
+			}
+			mHasRequest = false;
+			requestGeneration = mGeneration.load();
+		}
+
+		const Hint hint = findHint(grid, &mGeneration, requestGeneration);
+
+		// Publish unless the request went stale
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (mGeneration.load() == requestGeneration)
+		{
+			mResult = hint;
+			mHasResult = true;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+/* Hint engine finding the next logically deducible placement on a worker thread */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Sudoku
+{
+	// Hardest technique needed to deduce a hint
+	enum class HintTechnique
+	{
+		NONE = 0,
+		NAKED_SINGLE = 1,
+		HIDDEN_SINGLE = 2,
+		LOCKED_CANDIDATES = 3,
+		NAKED_PAIR = 4
+	};
+
+	// Placement deduced from a board
+	struct Hint
+	{
+		int index = -1;
+		int num = 0;
+		HintTechnique technique = HintTechnique::NONE;
+	};
+
+	class HintEngine
+	{
+	private:
+		// Worker thread and the lock protecting the request and result
+		std::thread mWorker;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mStop;
+
+		// Latest board requested (9 x 9 = 81, 0 = empty)
+		int mRequestGrid[81];
+		bool mHasRequest;
+
+		// Latest finished hint
+		Hint mResult;
+		bool mHasResult;
+
+		// Incremented by every request and cancel so stale work is dropped
+		std::atomic<unsigned int> mGeneration;
+
+	private:
+		// Worker thread loop
+		void run();
+
+	public:
+		// Find the next placement using bitmask candidates, giving up if the generation moves on
+		static Hint findHint(const int* grid, const std::atomic<unsigned int>* generation = nullptr, const unsigned int requestGeneration = 0);
+
+		// Constructor
+		HintEngine();
+
+		// Destructor to stop the worker thread
+		~HintEngine();
+
+		// Start and stop the worker thread
+		void start();
+		void stop();
+
+		// Request a hint for a board, cancelling any earlier request
+		void request(const int* grid);
+
+		// Cancel the current request (e.g. the board changed)
+		void cancel();
+
+		// Get the finished hint without blocking (returns false if none is ready)
+		bool poll(Hint& hint);
+
+	};
+
+};
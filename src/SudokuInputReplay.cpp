@@ -0,0 +1,395 @@
+#include "SudokuInputReplay.h"
+#include "SudokuPlatform.h"
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+
+namespace
+{
+	// File magic and format version
+	const uint8_t REPLAY_MAGIC[4] = { 'S', 'D', 'K', 'I' };
+	const uint8_t REPLAY_VERSION = 1;
+
+	// Size of the header (magic, version, seed, window size and record count)
+	const int HEADER_SIZE = 4 + 1 + 4 + 4 + 4 + 4;
+
+	// Little-endian 32-bit integers
+	void writeU32(uint8_t* bytes, const uint32_t value)
+	{
+		bytes[0] = (uint8_t)value;
+		bytes[1] = (uint8_t)(value >> 8);
+		bytes[2] = (uint8_t)(value >> 16);
+		bytes[3] = (uint8_t)(value >> 24);
+	}
+
+	uint32_t readU32(const uint8_t* bytes)
+	{
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+
+	// Copy text, truncating it to fit with its terminator
+	void copyText(char* to, const char* from, const size_t size)
+	{
+		size_t i = 0;
+		for (; i + 1 < size && from[i] != '\0'; i++)
+		{
+			to[i] = from[i];
+		}
+		to[i] = '\0';
+	}
+
+	// Summarize durations (milliseconds)
+	Sudoku::PhaseSummary summarize(std::vector<double>& durations)
+	{
+		Sudoku::PhaseSummary summary;
+		if (durations.empty())
+		{
+			return summary;
+		}
+
+		double total = 0.0;
+		for (size_t i = 0; i < durations.size(); i++)
+		{
+			total += durations[i];
+		}
+
+		// Partially sort for the 99th percentile
+		const size_t p99Index = (durations.size() * 99) / 100;
+		std::nth_element(durations.begin(), durations.begin() + p99Index, durations.end());
+
+		summary.p99 = durations[p99Index];
+		summary.min = *std::min_element(durations.begin(), durations.end());
+		summary.max = *std::max_element(durations.begin(), durations.end());
+		summary.avg = total / durations.size();
+		return summary;
+	}
+}
+
+Sudoku::InputReplay::InputReplay()
+	: mMode(ReplayMode::OFF),
+	  mSeed(0), mNextSeed(0), mWidth(0), mHeight(0),
+	  mNext(0), mStartTicks(0)
+{
+
+}
+
+void Sudoku::InputReplay::startRecording(const std::string& path, const uint32_t seed)
+{
+	mMode = ReplayMode::RECORDING;
+	mPath = path;
+	mSeed = seed;
+	mNextSeed = seed;
+	mRecords.clear();
+}
+
+bool Sudoku::InputReplay::load(const std::string& path)
+{
+	FILE* file = openFile(path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		std::cerr << "Could not open recording " << path << std::endl;
+		return false;
+	}
+
+	// Header
+	uint8_t header[HEADER_SIZE];
+	bool valid = fread(header, 1, HEADER_SIZE, file) == HEADER_SIZE && memcmp(header, REPLAY_MAGIC, 4) == 0 && header[4] == REPLAY_VERSION;
+	const uint32_t totalRecords = valid ? readU32(header + 17) : 0;
+
+	// Records
+	mRecords.clear();
+	uint8_t bytes[RECORD_SIZE];
+	for (uint32_t i = 0; i < totalRecords && valid; i++)
+	{
+		valid = fread(bytes, 1, RECORD_SIZE, file) == RECORD_SIZE;
+		InputRecord record;
+		record.time = readU32(bytes);
+		record.type = readU32(bytes + 4);
+		record.a = (int32_t)readU32(bytes + 8);
+		record.b = (int32_t)readU32(bytes + 12);
+		record.c = (int32_t)readU32(bytes + 16);
+		memcpy(record.text, bytes + 20, sizeof(record.text));
+		record.text[sizeof(record.text) - 1] = '\0';
+		mRecords.push_back(record);
+	}
+	fclose(file);
+	if (!valid)
+	{
+		std::cerr << path << " is not a valid recording" << std::endl;
+		mRecords.clear();
+		return false;
+	}
+
+	// The game only stops on quit, so end every replay with one
+	if (mRecords.empty() || mRecords.back().type != SDL_QUIT)
+	{
+		InputRecord quit;
+		quit.time = mRecords.empty() ? 0 : mRecords.back().time;
+		quit.type = SDL_QUIT;
+		mRecords.push_back(quit);
+	}
+
+	mMode = ReplayMode::REPLAYING;
+	mPath = path;
+	mSeed = readU32(header + 5);
+	mNextSeed = mSeed;
+	mWidth = (int)readU32(header + 9);
+	mHeight = (int)readU32(header + 13);
+	mNext = 0;
+	for (int phase = 0; phase < (int)FramePhase::TOTAL_PHASES; phase++)
+	{
+		mFrames[phase].clear();
+	}
+	return true;
+}
+
+void Sudoku::InputReplay::begin(const Uint32 ticks, const int width, const int height)
+{
+	mStartTicks = ticks;
+	if (mMode == ReplayMode::RECORDING)
+	{
+		mWidth = width;
+		mHeight = height;
+	}
+}
+
+Sudoku::ReplayMode Sudoku::InputReplay::getMode() const
+{
+	return mMode;
+}
+
+int Sudoku::InputReplay::getWidth() const
+{
+	return mWidth;
+}
+
+int Sudoku::InputReplay::getHeight() const
+{
+	return mHeight;
+}
+
+unsigned int Sudoku::InputReplay::nextSeed()
+{
+	return mNextSeed++;
+}
+
+void Sudoku::InputReplay::record(const SDL_Event& event, const Uint32 ticks)
+{
+	if (mMode != ReplayMode::RECORDING)
+	{
+		return;
+	}
+
+	InputRecord record;
+	record.time = ticks - mStartTicks;
+	record.type = event.type;
+	switch (event.type)
+	{
+	case SDL_QUIT:
+		break;
+	case SDL_WINDOWEVENT:
+		record.a = event.window.event;
+		record.b = event.window.data1;
+		record.c = event.window.data2;
+		break;
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		record.a = event.key.keysym.sym;
+		record.b = event.key.keysym.mod;
+		record.c = event.key.repeat;
+		break;
+	case SDL_TEXTINPUT:
+		copyText(record.text, event.text.text, sizeof(record.text));
+		break;
+	case SDL_MOUSEMOTION:
+		record.a = event.motion.x;
+		record.b = event.motion.y;
+		record.c = (int32_t)event.motion.state;
+		break;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		record.a = event.button.x;
+		record.b = event.button.y;
+		record.c = event.button.button | (event.button.clicks << 8);
+		break;
+	case SDL_MOUSEWHEEL:
+		record.a = event.wheel.x;
+		record.b = event.wheel.y;
+		break;
+	default:
+		// The game doesn't handle other events, and some hold pointers that can't be saved
+		return;
+	}
+	mRecords.push_back(record);
+}
+
+bool Sudoku::InputReplay::poll(SDL_Event* event, const Uint32 ticks, const Uint32 windowID)
+{
+	if (mMode != ReplayMode::REPLAYING || mNext >= mRecords.size() || mRecords[mNext].time > ticks - mStartTicks)
+	{
+		return false;
+	}
+
+	const InputRecord& record = mRecords[mNext++];
+	memset(event, 0, sizeof(SDL_Event));
+	event->type = record.type;
+	switch (record.type)
+	{
+	case SDL_WINDOWEVENT:
+		event->window.windowID = windowID;
+		event->window.event = (Uint8)record.a;
+		event->window.data1 = record.b;
+		event->window.data2 = record.c;
+		break;
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		event->key.windowID = windowID;
+		event->key.state = record.type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+		event->key.keysym.sym = record.a;
+		event->key.keysym.mod = (Uint16)record.b;
+		event->key.repeat = (Uint8)record.c;
+		break;
+	case SDL_TEXTINPUT:
+		event->text.windowID = windowID;
+		copyText(event->text.text, record.text, sizeof(record.text));
+		break;
+	case SDL_MOUSEMOTION:
+		event->motion.windowID = windowID;
+		event->motion.x = record.a;
+		event->motion.y = record.b;
+		event->motion.state = (Uint32)record.c;
+		break;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		event->button.windowID = windowID;
+		event->button.state = record.type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+		event->button.x = record.a;
+		event->button.y = record.b;
+		event->button.button = (Uint8)(record.c & 0xFF);
+		event->button.clicks = (Uint8)(record.c >> 8);
+		break;
+	case SDL_MOUSEWHEEL:
+		event->wheel.windowID = windowID;
+		event->wheel.x = record.a;
+		event->wheel.y = record.b;
+		break;
+	default:
+		break;
+	}
+	return true;
+}
+
+bool Sudoku::InputReplay::isFinished() const
+{
+	return mNext >= mRecords.size();
+}
+
+void Sudoku::InputReplay::recordFrame(const FrameStats& frameStats)
+{
+	if (mMode != ReplayMode::REPLAYING)
+	{
+		return;
+	}
+	for (int phase = 0; phase < (int)FramePhase::TOTAL_PHASES; phase++)
+	{
+		mFrames[phase].push_back(frameStats.getLast((FramePhase)phase));
+	}
+}
+
+int Sudoku::InputReplay::getTotalFrames() const
+{
+	return (int)mFrames[(int)FramePhase::FRAME].size();
+}
+
+Sudoku::PhaseSummary Sudoku::InputReplay::getSummary(const FramePhase phase) const
+{
+	std::vector<double> durations = mFrames[(int)phase];
+
+	// The first frame has no previous frame to be timed from
+	if (phase == FramePhase::FRAME && !durations.empty())
+	{
+		durations.erase(durations.begin());
+	}
+	return summarize(durations);
+}
+
+Sudoku::PhaseSummary Sudoku::InputReplay::getWorkSummary() const
+{
+	// Events, logic, render and present of every frame, leaving out the sleep between frames
+	std::vector<double> durations(mFrames[(int)FramePhase::EVENTS].size(), 0.0);
+	for (int phase = (int)FramePhase::EVENTS; phase < (int)FramePhase::TOTAL_PHASES; phase++)
+	{
+		for (size_t frame = 0; frame < durations.size(); frame++)
+		{
+			durations[frame] += mFrames[phase][frame];
+		}
+	}
+	return summarize(durations);
+}
+
+bool Sudoku::InputReplay::writeFrames(const std::string& path) const
+{
+	FILE* file = openFile(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		std::cerr << "Could not open " << path << std::endl;
+		return false;
+	}
+	fprintf(file, "frame,frame_ms,events_ms,logic_ms,render_ms,present_ms\n");
+	for (int frame = 0; frame < getTotalFrames(); frame++)
+	{
+		fprintf(file, "%d", frame);
+		for (int phase = 0; phase < (int)FramePhase::TOTAL_PHASES; phase++)
+		{
+			fprintf(file, ",%.3f", mFrames[phase][frame]);
+		}
+		fprintf(file, "\n");
+	}
+	return fclose(file) == 0;
+}
+
+bool Sudoku::InputReplay::finish()
+{
+	if (mMode != ReplayMode::RECORDING)
+	{
+		return true;
+	}
+	mMode = ReplayMode::OFF;
+
+	FILE* file = openFile(mPath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		std::cerr << "Could not write recording " << mPath << std::endl;
+		return false;
+	}
+
+	// Header
+	uint8_t header[HEADER_SIZE];
+	memcpy(header, REPLAY_MAGIC, 4);
+	header[4] = REPLAY_VERSION;
+	writeU32(header + 5, mSeed);
+	writeU32(header + 9, (uint32_t)mWidth);
+	writeU32(header + 13, (uint32_t)mHeight);
+	writeU32(header + 17, (uint32_t)mRecords.size());
+	bool written = fwrite(header, 1, HEADER_SIZE, file) == HEADER_SIZE;
+
+	// Records
+	uint8_t bytes[RECORD_SIZE];
+	for (size_t i = 0; i < mRecords.size() && written; i++)
+	{
+		const InputRecord& record = mRecords[i];
+		writeU32(bytes, record.time);
+		writeU32(bytes + 4, record.type);
+		writeU32(bytes + 8, (uint32_t)record.a);
+		writeU32(bytes + 12, (uint32_t)record.b);
+		writeU32(bytes + 16, (uint32_t)record.c);
+		memcpy(bytes + 20, record.text, sizeof(record.text));
+		written = fwrite(bytes, 1, RECORD_SIZE, file) == RECORD_SIZE;
+	}
+	written = fclose(file) == 0 && written;
+	if (written)
+	{
+		std::cout << "Recorded " << mRecords.size() << " input events to " << mPath << std::endl;
+	}
+	return written;
+}
@@ -0,0 +1,108 @@
+/* Recording of input events with timestamps and headless replay of them with per-frame timing */
+#pragma once
+#include <SDL.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "SudokuFrameStats.h"
+
+namespace Sudoku
+{
+	// Whether input is recorded, replayed or neither
+	enum class ReplayMode
+	{
+		OFF = 0,
+		RECORDING = 1,
+		REPLAYING = 2
+	};
+
+	// Input event as recorded (only the event types the game handles are kept)
+	struct InputRecord
+	{
+		// Milliseconds since recording began
+		uint32_t time = 0;
+
+		// SDL event type and its fields: window event and size, key and modifiers, mouse position and button or state
+		uint32_t type = 0;
+		int32_t a = 0;
+		int32_t b = 0;
+		int32_t c = 0;
+
+		// Typed text (numbers are a single character)
+		char text[8] = { };
+	};
+
+	class InputReplay
+	{
+	public:
+		// Size of an encoded record in bytes
+		static const int RECORD_SIZE = 4 + 4 + 4 + 4 + 4 + 8;
+
+	private:
+		// Mode and the recording file
+		ReplayMode mMode;
+		std::string mPath;
+
+		// Seed of the first puzzle (every new puzzle uses the next seed) and the window size the recording was made at
+		uint32_t mSeed;
+		uint32_t mNextSeed;
+		int mWidth;
+		int mHeight;
+
+		// Events recorded or to replay, the next one to replay and when recording or replay began (SDL ticks)
+		std::vector<InputRecord> mRecords;
+		size_t mNext;
+		Uint32 mStartTicks;
+
+		// Duration of every phase of every frame played while replaying (milliseconds)
+		std::vector<double> mFrames[(int)FramePhase::TOTAL_PHASES];
+
+	public:
+		// Constructor
+		InputReplay();
+
+		// Record input of the next game to a file
+		void startRecording(const std::string& path, const uint32_t seed);
+
+		// Load a recording to replay, returning false if it is missing or not a valid recording
+		bool load(const std::string& path);
+
+		// Start the recording or replay clock once the game is ready (the window size is only stored when recording)
+		void begin(const Uint32 ticks, const int width, const int height);
+
+		// Get mode and the window size of the recording
+		ReplayMode getMode() const;
+		int getWidth() const;
+		int getHeight() const;
+
+		// Get seed for the next puzzle, so replayed games play the same puzzles as recorded
+		unsigned int nextSeed();
+
+		// Record an event polled at a time (SDL ticks)
+		void record(const SDL_Event& event, const Uint32 ticks);
+
+		// Get the next recorded event due at a time (SDL ticks), returning false if none is due yet
+		bool poll(SDL_Event* event, const Uint32 ticks, const Uint32 windowID);
+
+		// Check if every recorded event has been replayed
+		bool isFinished() const;
+
+		// Keep the phase durations of the frame just committed
+		void recordFrame(const FrameStats& frameStats);
+
+		// Get number of frames timed and a summary of one phase over all of them
+		int getTotalFrames() const;
+		PhaseSummary getSummary(const FramePhase phase) const;
+
+		// Get summary of the work of every frame (events, logic, render and present, without the sleep that paces frames)
+		PhaseSummary getWorkSummary() const;
+
+		// Write phase durations of every frame timed as comma separated values
+		bool writeFrames(const std::string& path) const;
+
+		// Write the recording (nothing is written unless recording)
+		bool finish();
+
+	};
+
+};
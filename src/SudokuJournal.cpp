@@ -0,0 +1,58 @@
+#include "SudokuJournal.h"
+
+Sudoku::Journal::Journal()
+	: mCursor(0)
+{
+
+}
+
+void Sudoku::Journal::reset()
+{
+	mRecords.clear();
+	mCursor = 0;
+}
+
+void Sudoku::Journal::record(const int index, const int oldValue, const int newValue, const uint16_t oldNotes, const uint16_t newNotes, const uint32_t timestamp, const bool chained)
+{
+	// A new edit replaces the edits that were undone
+	if (mCursor < (int)mRecords.size())
+	{
+		mRecords.resize(mCursor);
+	}
+
+	JournalRecord record;
+	record.index = (uint8_t)index;
+	record.oldValue = (uint8_t)oldValue;
+	record.newValue = (uint8_t)newValue;
+	record.flags = chained ? JournalRecord::CHAINED : 0;
+	record.oldNotes = oldNotes;
+	record.newNotes = newNotes;
+	record.timestamp = timestamp;
+	mRecords.push_back(record);
+	mCursor++;
+}
+
+bool Sudoku::Journal::undo(JournalRecord& record)
+{
+	if (mCursor == 0)
+	{
+		return false;
+	}
+	record = mRecords[--mCursor];
+	return true;
+}
+
+bool Sudoku::Journal::redo(JournalRecord& record)
+{
+	if (mCursor == (int)mRecords.size())
+	{
+		return false;
+	}
+	record = mRecords[mCursor++];
+	return true;
+}
+
+bool Sudoku::Journal::isRedoChained() const
+{
+	return mCursor < (int)mRecords.size() && (mRecords[mCursor].flags & JournalRecord::CHAINED) != 0;
+}
@@ -0,0 +1,49 @@
+/* Undo and redo journal of small fixed-size edit records */
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+namespace Sudoku
+{
+	// One edit of one cell (12 bytes)
+	struct JournalRecord
+	{
+		// Record belongs to the same action as the record before it (undone and redone together)
+		static const uint8_t CHAINED = 1;
+
+		uint8_t index = 0;
+		uint8_t oldValue = 0;
+		uint8_t newValue = 0;
+		uint8_t flags = 0;
+		uint16_t oldNotes = 0;
+		uint16_t newNotes = 0;
+		uint32_t timestamp = 0;
+	};
+
+	class Journal
+	{
+	private:
+		// Edits in order; records before the cursor are applied, records after it can be redone
+		std::vector<JournalRecord> mRecords;
+		int mCursor;
+
+	public:
+		// Constructor
+		Journal();
+
+		// Start a new journal, forgetting every edit
+		void reset();
+
+		// Append an edit at the cursor, discarding edits that were undone (chained edits belong to the previous record's action)
+		void record(const int index, const int oldValue, const int newValue, const uint16_t oldNotes, const uint16_t newNotes, const uint32_t timestamp, const bool chained = false);
+
+		// Step back or forward, returning the record to revert or apply (false if there is none)
+		bool undo(JournalRecord& record);
+		bool redo(JournalRecord& record);
+
+		// Check if the next record to redo belongs to the action just redone
+		bool isRedoChained() const;
+
+	};
+
+};
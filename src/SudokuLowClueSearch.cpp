@@ -0,0 +1,260 @@
+#include "SudokuLowClueSearch.h"
+#include "SudokuPlatform.h"
+#include "SudokuPuzzleIO.h"
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	// Shuffle cells in place
+	void shuffle(int* cells, const int count, std::minstd_rand& random)
+	{
+		for (int i = count - 1; i > 0; i--)
+		{
+			const int j = (int)(random() % (unsigned int)(i + 1));
+			const int swap = cells[i];
+			cells[i] = cells[j];
+			cells[j] = swap;
+		}
+	}
+
+	// Check that a puzzle has exactly one solution
+	bool isUnique(const int* puzzle, Sudoku::VariantSolver<Sudoku::ClassicRules>& solver, int64_t& checks)
+	{
+		checks++;
+		return solver.setGrid(puzzle) && solver.countSolutions(2) == 1;
+	}
+}
+
+Sudoku::LowClueSearch::LowClueSearch()
+	: mStop(false), mChecks(0), mGrids(0), mBestClues(81), mMinimalCounts()
+{
+
+}
+
+int Sudoku::LowClueSearch::reduce(int* puzzle, const int* solution, std::minstd_rand& random, VariantSolver<ClassicRules>& solver, int64_t& checks) const
+{
+	int clues[81];
+	int totalClues = 0;
+	for (int cell = 0; cell < 81; cell++)
+	{
+		if (puzzle[cell] != 0)
+		{
+			clues[totalClues++] = cell;
+		}
+	}
+	shuffle(clues, totalClues, random);
+
+	int left = totalClues;
+	for (int i = 0; i < totalClues && !mStop; i++)
+	{
+		puzzle[clues[i]] = 0;
+		if (isUnique(puzzle, solver, checks))
+		{
+			left--;
+		}
+		else
+		{
+			puzzle[clues[i]] = solution[clues[i]];
+		}
+	}
+	return left;
+}
+
+void Sudoku::LowClueSearch::record(const int* puzzle, const int* solution, const int clues, const int targetClues)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (clues > mBestClues)
+	{
+		return;
+	}
+	if (clues < mBestClues)
+	{
+		// Puzzles kept so far have more clues than the new best
+		mBestClues = clues;
+		mPuzzles.clear();
+		mKept.clear();
+	}
+
+	// Moves that keep the clue count can come back to a puzzle already kept
+	uint64_t hash = 14695981039346656037ull;
+	for (int i = 0; i < 81; i++)
+	{
+		hash = (hash ^ (uint64_t)puzzle[i]) * 1099511628211ull;
+	}
+	if ((int)mPuzzles.size() < MAX_RESULTS && mKept.insert(hash).second)
+	{
+		LowCluePuzzle found;
+		for (int i = 0; i < 81; i++)
+		{
+			found.puzzle[i] = puzzle[i];
+			found.solution[i] = solution[i];
+		}
+		found.clues = clues;
+		mPuzzles.push_back(found);
+	}
+	if (clues <= targetClues)
+	{
+		mStop = true;
+	}
+}
+
+void Sudoku::LowClueSearch::runThread(const unsigned int seed, const double seconds, const int targetClues)
+{
+	const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::microseconds((int64_t)(seconds * 1000000.0));
+	std::minstd_rand random(seed);
+	VariantSolver<ClassicRules> solver;
+	int64_t checks = 0;
+	const int empty[81] = { };
+
+	while (!mStop)
+	{
+		// 1. Fill an empty grid in random order for a random completed grid
+		int solution[81];
+		solver.setRandom(&random);
+		solver.setGrid(empty);
+		solver.solve(solution);
+		solver.setRandom(nullptr);
+
+		// 2. Remove clues in random order down to a minimal puzzle
+		int puzzle[81];
+		for (int i = 0; i < 81; i++)
+		{
+			puzzle[i] = solution[i];
+		}
+		int clues = reduce(puzzle, solution, random, solver, checks);
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mMinimalCounts[clues]++;
+		}
+		record(puzzle, solution, clues, targetClues);
+
+		// 3. Local search: swap a clue for a cell that isn't one, then remove what clues can go, keeping moves that don't add clues
+		for (int move = 0; move < MOVES_PER_GRID && !mStop; move++)
+		{
+			int trial[81];
+			int clueCells[81];
+			int emptyCells[81];
+			int totalClues = 0;
+			int totalEmpty = 0;
+			for (int cell = 0; cell < 81; cell++)
+			{
+				trial[cell] = puzzle[cell];
+				if (puzzle[cell] != 0)
+				{
+					clueCells[totalClues++] = cell;
+				}
+				else
+				{
+					emptyCells[totalEmpty++] = cell;
+				}
+			}
+			const int removed = clueCells[random() % (unsigned int)totalClues];
+			const int added = emptyCells[random() % (unsigned int)totalEmpty];
+			trial[removed] = 0;
+			trial[added] = solution[added];
+			if (!isUnique(trial, solver, checks))
+			{
+				continue;
+			}
+
+			const int trialClues = reduce(trial, solution, random, solver, checks);
+			if (trialClues <= clues)
+			{
+				for (int i = 0; i < 81; i++)
+				{
+					puzzle[i] = trial[i];
+				}
+				clues = trialClues;
+
+				// Keep every new puzzle matching the fewest clues, including ones reached by moves that didn't remove a clue
+				if (clues <= getBestClues())
+				{
+					record(puzzle, solution, clues, targetClues);
+				}
+			}
+
+			// Check the time between moves (a move is at most a few dozen checks)
+			if (std::chrono::steady_clock::now() >= end)
+			{
+				mStop = true;
+			}
+		}
+
+		mGrids++;
+		mChecks += checks;
+		checks = 0;
+		if (std::chrono::steady_clock::now() >= end)
+		{
+			mStop = true;
+		}
+	}
+	mChecks += checks;
+}
+
+void Sudoku::LowClueSearch::run(const double seconds, const int threads, const unsigned int seed, const int targetClues)
+{
+	mStop = false;
+	mChecks = 0;
+	mGrids = 0;
+	mBestClues = 81;
+	mPuzzles.clear();
+	mKept.clear();
+	for (int i = 0; i < 82; i++)
+	{
+		mMinimalCounts[i] = 0;
+	}
+
+	// Every thread searches its own grids, sharing only the best clue count
+	const int totalThreads = threads > 0 ? threads : 1;
+	std::vector<std::thread> workers;
+	for (int thread = 0; thread < totalThreads; thread++)
+	{
+		workers.push_back(std::thread(&LowClueSearch::runThread, this, seed + (unsigned int)thread * 7919u, seconds, targetClues));
+	}
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+int Sudoku::LowClueSearch::getBestClues() const
+{
+	return mBestClues;
+}
+
+const std::vector<Sudoku::LowCluePuzzle>& Sudoku::LowClueSearch::getPuzzles() const
+{
+	return mPuzzles;
+}
+
+int64_t Sudoku::LowClueSearch::getChecks() const
+{
+	return mChecks;
+}
+
+int64_t Sudoku::LowClueSearch::getGrids() const
+{
+	return mGrids;
+}
+
+int64_t Sudoku::LowClueSearch::getMinimalCount(const int clues) const
+{
+	return clues >= 0 && clues <= 81 ? mMinimalCounts[clues] : 0;
+}
+
+bool Sudoku::LowClueSearch::writePuzzles(const std::string& path) const
+{
+	PuzzleWriter writer;
+	if (!writer.open(path))
+	{
+		return false;
+	}
+	for (size_t i = 0; i < mPuzzles.size(); i++)
+	{
+		char comment[32];
+		const int commentLength = snprintf(comment, sizeof(comment), "clues %d", mPuzzles[i].clues);
+		writer.write(mPuzzles[i].puzzle, comment, commentLength);
+	}
+	return writer.close();
+}
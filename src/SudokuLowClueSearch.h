@@ -0,0 +1,81 @@
+/* Search for unique puzzles with as few clues as possible across threads */
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "SudokuVariantSolver.h"
+
+namespace Sudoku
+{
+	// Unique puzzle found by the search and its clue count
+	struct LowCluePuzzle
+	{
+		int puzzle[81];
+		int solution[81];
+		int clues = 0;
+	};
+
+	class LowClueSearch
+	{
+	public:
+		// Local search moves made from one completed grid before starting again from a new one
+		static const int MOVES_PER_GRID = 2048;
+
+		// Puzzles kept (every puzzle found with the fewest clues, up to this many)
+		static const int MAX_RESULTS = 4096;
+
+	private:
+		// Set once the time is up or the target is reached
+		std::atomic<bool> mStop;
+
+		// Uniqueness checks made and completed grids searched across all threads
+		std::atomic<int64_t> mChecks;
+		std::atomic<int64_t> mGrids;
+
+		// Fewest clues found so far (read by threads without the lock), the puzzles found with it and a hash of each
+		std::mutex mMutex;
+		std::atomic<int> mBestClues;
+		std::vector<LowCluePuzzle> mPuzzles;
+		std::unordered_set<uint64_t> mKept;
+
+		// Number of grids whose first minimal puzzle had each clue count
+		int64_t mMinimalCounts[82];
+
+	private:
+		// Search from new completed grids until stopped
+		void runThread(const unsigned int seed, const double seconds, const int targetClues);
+
+		// Remove clues in an order while the puzzle stays unique, returning the clues left (none can be removed after)
+		int reduce(int* puzzle, const int* solution, std::minstd_rand& random, VariantSolver<ClassicRules>& solver, int64_t& checks) const;
+
+		// Keep a puzzle if it matches the fewest clues found so far, or replace the puzzles kept if it beats it
+		void record(const int* puzzle, const int* solution, const int clues, const int targetClues);
+
+	public:
+		// Constructor
+		LowClueSearch();
+
+		// Search on several threads for a number of seconds or until a puzzle with targetClues clues or fewer is found
+		void run(const double seconds, const int threads, const unsigned int seed, const int targetClues);
+
+		// Get fewest clues found (81 if nothing was found) and the puzzles found with it, in the order found
+		int getBestClues() const;
+		const std::vector<LowCluePuzzle>& getPuzzles() const;
+
+		// Get uniqueness checks made and completed grids searched by the last run
+		int64_t getChecks() const;
+		int64_t getGrids() const;
+
+		// Get number of grids whose first minimal puzzle had a number of clues
+		int64_t getMinimalCount(const int clues) const;
+
+		// Write the puzzles kept with their clue counts as comments
+		bool writePuzzles(const std::string& path) const;
+
+	};
+
+};
@@ -0,0 +1,129 @@
+#include "SudokuParallelCounter.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+Sudoku::ParallelCounter::ParallelCounter()
+	: mNextShare(0), mFinishedThreads(0), mTotal(),
+	  mStatus(SolveStatus::NO_SOLUTION), mFirstBands(0), mSeconds(0.0)
+{
+
+}
+
+void Sudoku::ParallelCounter::runThread(const int thread, const int* grid, const int totalShares, const SolveLimits limits)
+{
+	BandEnumerator& enumerator = *mEnumerators[thread];
+	for (int share = mNextShare++; share < totalShares; share = mNextShare++)
+	{
+		const GridCount counted = enumerator.countShare(grid, share, totalShares, limits);
+		const SolveStatus status = enumerator.getStatus();
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (status == SolveStatus::CANCELLED || status == SolveStatus::TIMED_OUT)
+		{
+			if (mStatus == SolveStatus::SOLVED)
+			{
+				mStatus = status;
+			}
+			break;
+		}
+		mTotal.add(counted);
+	}
+	mFinishedThreads++;
+}
+
+void Sudoku::ParallelCounter::reportProgress(const double seconds) const
+{
+	const uint64_t firstBandsDone = getFirstBandsDone();
+	GridCount counted;
+	for (size_t i = 0; i < mEnumerators.size(); i++)
+	{
+		counted.add(mEnumerators[i]->getCounted());
+	}
+	const double rate = seconds > 0.0 ? counted.toDouble() / seconds : 0.0;
+	char line[192];
+	snprintf(line, sizeof(line), "%.1f s: %llu of %llu first bands (%.1f%%), %s solutions (%.3g per second)", seconds,
+		(unsigned long long)firstBandsDone, (unsigned long long)mFirstBands, mFirstBands > 0 ? 100.0 * firstBandsDone / mFirstBands : 100.0,
+		counted.toString().c_str(), rate);
+	std::cerr << line << std::endl;
+}
+
+Sudoku::GridCount Sudoku::ParallelCounter::run(const int* grid, const int threads, const SolveLimits& limits, const bool progress)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	const int totalThreads = threads > 0 ? threads : 1;
+	mEnumerators.clear();
+	for (int thread = 0; thread < totalThreads; thread++)
+	{
+		mEnumerators.push_back(std::unique_ptr<BandEnumerator>(new BandEnumerator()));
+	}
+	mNextShare = 0;
+	mFinishedThreads = 0;
+	mTotal = GridCount();
+	mStatus = SolveStatus::SOLVED;
+	mSeconds = 0.0;
+
+	// No first bands means the givens clash or leave the fullest band no way to be filled
+	mFirstBands = mEnumerators[0]->countFirstBands(grid);
+	if (mFirstBands == 0)
+	{
+		mStatus = SolveStatus::NO_SOLUTION;
+		return GridCount();
+	}
+
+	// A grid with a single thread counts in one share, the same way as BandEnumerator::count
+	const int totalShares = totalThreads > 1 ? totalThreads * SHARES_PER_THREAD : 1;
+	std::vector<std::thread> workers;
+	for (int thread = 0; thread < totalThreads; thread++)
+	{
+		workers.push_back(std::thread(&ParallelCounter::runThread, this, thread, grid, totalShares, limits));
+	}
+
+	// Report progress while the threads count
+	std::chrono::steady_clock::time_point nextReport = start + std::chrono::milliseconds(PROGRESS_INTERVAL);
+	while (progress && mFinishedThreads < totalThreads)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now >= nextReport && mFinishedThreads < totalThreads)
+		{
+			reportProgress(std::chrono::duration<double>(now - start).count());
+			nextReport += std::chrono::milliseconds(PROGRESS_INTERVAL);
+		}
+	}
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	mSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	if (mStatus == SolveStatus::SOLVED && mTotal.isZero())
+	{
+		mStatus = SolveStatus::NO_SOLUTION;
+	}
+	return mTotal;
+}
+
+Sudoku::SolveStatus Sudoku::ParallelCounter::getStatus() const
+{
+	return mStatus;
+}
+
+uint64_t Sudoku::ParallelCounter::getFirstBands() const
+{
+	return mFirstBands;
+}
+
+uint64_t Sudoku::ParallelCounter::getFirstBandsDone() const
+{
+	uint64_t firstBandsDone = 0;
+	for (size_t i = 0; i < mEnumerators.size(); i++)
+	{
+		firstBandsDone += mEnumerators[i]->getFirstBandsDone();
+	}
+	return firstBandsDone;
+}
+
+double Sudoku::ParallelCounter::getSeconds() const
+{
+	return mSeconds;
+}
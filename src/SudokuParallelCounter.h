@@ -0,0 +1,62 @@
+/* Exact solution counts of sparse grids with the band enumerator, sharing first bands out across threads */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+#include "SudokuBandEnumerator.h"
+
+namespace Sudoku
+{
+	class ParallelCounter
+	{
+	public:
+		// Shares of the first bands per thread (threads take the next share when they finish one, so a slow share holds up only one thread)
+		static const int SHARES_PER_THREAD = 16;
+
+		// Milliseconds between progress reports
+		static const int PROGRESS_INTERVAL = 1000;
+
+	private:
+		// Band enumerator of every thread (each keeps its own memos across the shares it takes)
+		std::vector<std::unique_ptr<BandEnumerator>> mEnumerators;
+
+		// Next share to take and threads finished
+		std::atomic<int> mNextShare;
+		std::atomic<int> mFinishedThreads;
+
+		// Completions counted in finished shares and how the count ended (the first thread stopped by the limits sets it)
+		std::mutex mMutex;
+		GridCount mTotal;
+		SolveStatus mStatus;
+
+		// First bands of the grid and seconds the last count took
+		uint64_t mFirstBands;
+		double mSeconds;
+
+	private:
+		// Take shares and count them until there are none left or the limits are reached
+		void runThread(const int thread, const int* grid, const int totalShares, const SolveLimits limits);
+
+		// Write first bands done, completions so far and how fast they are counted
+		void reportProgress(const double seconds) const;
+
+	public:
+		// Constructor
+		ParallelCounter();
+
+		// Count complete grids that keep the givens of a grid on a number of threads, writing progress to standard error if asked
+		GridCount run(const int* grid, const int threads, const SolveLimits& limits = SolveLimits(), const bool progress = false);
+
+		// Get how the last count ended (SOLVED if finished, NO_SOLUTION if there were none, or why it stopped)
+		SolveStatus getStatus() const;
+
+		// Get first bands of the grid, how many were counted through and seconds the last count took
+		uint64_t getFirstBands() const;
+		uint64_t getFirstBandsDone() const;
+		double getSeconds() const;
+
+	};
+
+};
@@ -0,0 +1,128 @@
+/* Small wrappers over file functions that differ between Windows and POSIX */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Sudoku
+{
+	// Open file (returns nullptr on failure)
+	inline FILE* openFile(const char* path, const char* mode)
+	{
+#ifdef _WIN32
+		FILE* file = nullptr;
+		if (fopen_s(&file, path, mode) != 0)
+		{
+			return nullptr;
+		}
+		return file;
+#else
+		return fopen(path, mode);
+#endif
+	}
+
+	// Flush file buffers through to storage
+	inline bool syncFile(FILE* file)
+	{
+		if (fflush(file) != 0)
+		{
+			return false;
+		}
+#ifdef _WIN32
+		return _commit(_fileno(file)) == 0;
+#else
+		return fsync(fileno(file)) == 0;
+#endif
+	}
+
+	// Atomically replace a file with another one
+	inline bool replaceFile(const char* from, const char* to)
+	{
+#ifdef _WIN32
+		return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return rename(from, to) == 0;
+#endif
+	}
+
+	// Map a whole file read-only into memory (returns nullptr on failure or for an empty file)
+	inline const uint8_t* mapFile(const char* path, size_t& size)
+	{
+		size = 0;
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return nullptr;
+		}
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = nullptr;
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		}
+		CloseHandle(file);
+		if (mapping == nullptr)
+		{
+			return nullptr;
+		}
+
+		// The view keeps the mapping alive after its handle is closed
+		const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (data == nullptr)
+		{
+			return nullptr;
+		}
+		size = (size_t)fileSize.QuadPart;
+		return (const uint8_t*)data;
+#else
+		const int file = ::open(path, O_RDONLY);
+		if (file < 0)
+		{
+			return nullptr;
+		}
+		struct stat status;
+		void* data = MAP_FAILED;
+		if (fstat(file, &status) == 0 && status.st_size > 0)
+		{
+			data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		}
+		::close(file);
+		if (data == MAP_FAILED)
+		{
+			return nullptr;
+		}
+		size = (size_t)status.st_size;
+		return (const uint8_t*)data;
+#endif
+	}
+
+	// Unmap a file mapped with mapFile
+	inline void unmapFile(const uint8_t* data, const size_t size)
+	{
+#ifdef _WIN32
+		(void)size;
+		UnmapViewOfFile(data);
+#else
+		munmap((void*)data, size);
+#endif
+	}
+
+};
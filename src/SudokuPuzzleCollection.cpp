@@ -0,0 +1,146 @@
+#include "SudokuPuzzleCollection.h"
+#include "SudokuPlatform.h"
+#include "SudokuPuzzleIO.h"
+#include <chrono>
+#include <string.h>
+
+Sudoku::PuzzleCollection::PuzzleCollection()
+	: mData(nullptr), mSize(0),
+	  mCount(0),
+	  mIndexed(false), mStop(false), mIndexTime(0.0)
+{
+
+}
+
+Sudoku::PuzzleCollection::~PuzzleCollection()
+{
+	close();
+}
+
+void Sudoku::PuzzleCollection::buildIndex()
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint8_t cells[81];
+	size_t position = 0;
+	size_t count = 0;
+	while (position < mSize && !mStop)
+	{
+		// Find end of line
+		const char* line = (const char*)mData + position;
+		const size_t remaining = mSize - position;
+		const char* newline = (const char*)memchr(line, '\n', remaining);
+		size_t length = newline != nullptr ? (size_t)(newline - line) : remaining;
+		const size_t lineStart = position;
+		position += newline != nullptr ? length + 1 : length;
+		if (length > 0 && line[length - 1] == '\r')
+		{
+			length--;
+		}
+
+		// Publish every puzzle as soon as it is found, so the first page shows without waiting for the rest
+		if (PuzzleReader::parseLine(line, length, cells) >= 0)
+		{
+			mOffsets[count++] = lineStart;
+			mCount.store(count, std::memory_order_release);
+		}
+	}
+	mIndexTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	mIndexed.store(true, std::memory_order_release);
+}
+
+bool Sudoku::PuzzleCollection::open(const std::string& path)
+{
+	close();
+
+	mData = mapFile(path.c_str(), mSize);
+	if (mData == nullptr)
+	{
+		return false;
+	}
+	mPath = path;
+
+	// Every puzzle line takes at least 81 characters and a line ending (except the last)
+	mOffsets.reset(new uint64_t[mSize / 82 + 1]);
+	mStop = false;
+	mIndexer = std::thread(&PuzzleCollection::buildIndex, this);
+	return true;
+}
+
+void Sudoku::PuzzleCollection::close()
+{
+	mStop = true;
+	if (mIndexer.joinable())
+	{
+		mIndexer.join();
+	}
+	if (mData != nullptr)
+	{
+		unmapFile(mData, mSize);
+		mData = nullptr;
+	}
+	mSize = 0;
+	mPath.clear();
+	mOffsets.reset();
+	mCount = 0;
+	mIndexed = false;
+	mIndexTime = 0.0;
+}
+
+bool Sudoku::PuzzleCollection::isOpen() const
+{
+	return mData != nullptr;
+}
+
+const std::string& Sudoku::PuzzleCollection::getPath() const
+{
+	return mPath;
+}
+
+size_t Sudoku::PuzzleCollection::getCount() const
+{
+	return mCount.load(std::memory_order_acquire);
+}
+
+bool Sudoku::PuzzleCollection::isIndexed() const
+{
+	return mIndexed.load(std::memory_order_acquire);
+}
+
+double Sudoku::PuzzleCollection::getIndexTime() const
+{
+	return isIndexed() ? mIndexTime : 0.0;
+}
+
+bool Sudoku::PuzzleCollection::getPuzzle(const size_t index, uint8_t* cells) const
+{
+	if (index >= getCount())
+	{
+		return false;
+	}
+
+	// Only the puzzle's own line is read
+	const size_t position = (size_t)mOffsets[index];
+	const char* line = (const char*)mData + position;
+	const size_t remaining = mSize - position;
+	const char* newline = (const char*)memchr(line, '\n', remaining);
+	size_t length = newline != nullptr ? (size_t)(newline - line) : remaining;
+	if (length > 0 && line[length - 1] == '\r')
+	{
+		length--;
+	}
+	return PuzzleReader::parseLine(line, length, cells) >= 0;
+}
+
+bool Sudoku::PuzzleCollection::getPuzzle(const size_t index, int* grid) const
+{
+	uint8_t cells[81];
+	if (!getPuzzle(index, cells))
+	{
+		return false;
+	}
+	for (int i = 0; i < 81; i++)
+	{
+		grid[i] = cells[i];
+	}
+	return true;
+}
@@ -0,0 +1,63 @@
+/* Memory-mapped puzzle collection with a line index built in the background, for browsing files too large to read up front */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <thread>
+
+namespace Sudoku
+{
+	class PuzzleCollection
+	{
+	private:
+		// Mapped collection file (one puzzle per line, as read by PuzzleReader) and its path
+		const uint8_t* mData;
+		size_t mSize;
+		std::string mPath;
+
+		// Offset of every puzzle line found so far (room for as many as the file could hold; only the first mCount are set)
+		std::unique_ptr<uint64_t[]> mOffsets;
+		std::atomic<size_t> mCount;
+
+		// Indexer thread, whether it has gone through the whole file and the time it took (milliseconds, set before mIndexed)
+		std::thread mIndexer;
+		std::atomic<bool> mIndexed;
+		std::atomic<bool> mStop;
+		double mIndexTime;
+
+	private:
+		// Indexer thread: find every puzzle line, publishing each one as it is found
+		void buildIndex();
+
+	public:
+		// Constructor
+		PuzzleCollection();
+
+		// Destructor to stop the indexer and unmap the file
+		~PuzzleCollection();
+
+		// Map a collection and start indexing it in the background (returns false if it can't be mapped, which includes empty files)
+		bool open(const std::string& path);
+
+		// Stop the indexer and unmap the file
+		void close();
+
+		// Check if a collection is open and get its path
+		bool isOpen() const;
+		const std::string& getPath() const;
+
+		// Get number of puzzles indexed so far (safe to call while indexing)
+		size_t getCount() const;
+
+		// Check if indexing has finished and get the time it took (milliseconds, 0 until finished)
+		bool isIndexed() const;
+		double getIndexTime() const;
+
+		// Read one indexed puzzle into 81 numbers (0 for blanks) straight from the mapped file (returns false if it isn't indexed yet)
+		bool getPuzzle(const size_t index, uint8_t* cells) const;
+		bool getPuzzle(const size_t index, int* grid) const;
+
+	};
+
+};
@@ -0,0 +1,309 @@
+#include "SudokuPuzzleIO.h"
+#include "SudokuPlatform.h"
+#include <string.h>
+
+// Validate 16 cells at a time where SSE2 is available (always on x64)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SUDOKU_PUZZLE_IO_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Characters allowed between the cells and the comment
+	bool isSeparator(const char c)
+	{
+		return c == ' ' || c == '\t' || c == ',' || c == ';' || c == ':' || c == '|' || c == '#';
+	}
+}
+
+Sudoku::PuzzleReader::PuzzleReader()
+	: mData(nullptr), mSize(0), mPosition(0),
+	  mComment(nullptr), mCommentLength(0),
+	  mLine(0), mSkipped(0)
+{
+
+}
+
+Sudoku::PuzzleReader::~PuzzleReader()
+{
+	close();
+}
+
+bool Sudoku::PuzzleReader::open(const std::string& path)
+{
+	close();
+
+	mData = mapFile(path.c_str(), mSize);
+	if (mData == nullptr)
+	{
+		// An empty file can't be mapped but is still a valid (empty) input
+		FILE* file = openFile(path.c_str(), "rb");
+		if (file == nullptr)
+		{
+			return false;
+		}
+		fclose(file);
+	}
+	return true;
+}
+
+void Sudoku::PuzzleReader::close()
+{
+	if (mData != nullptr)
+	{
+		unmapFile(mData, mSize);
+		mData = nullptr;
+	}
+	mSize = 0;
+	mPosition = 0;
+	mComment = nullptr;
+	mCommentLength = 0;
+	mLine = 0;
+	mSkipped = 0;
+}
+
+bool Sudoku::PuzzleReader::parseCells(const char* text, uint8_t* cells)
+{
+	int cell = 0;
+
+#ifdef SUDOKU_PUZZLE_IO_SSE2
+	const __m128i dot = _mm_set1_epi8('.');
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i nine = _mm_set1_epi8(9);
+	for (; cell + 16 <= 81; cell += 16)
+	{
+		// Replace . with 0, then subtract '0' so valid cells are 0 to 9 (anything else wraps above 9)
+		__m128i chars = _mm_loadu_si128((const __m128i*)(text + cell));
+		const __m128i dots = _mm_cmpeq_epi8(chars, dot);
+		chars = _mm_or_si128(_mm_andnot_si128(dots, chars), _mm_and_si128(dots, zero));
+		const __m128i numbers = _mm_sub_epi8(chars, zero);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(numbers, nine), nine)) != 0xFFFF)
+		{
+			return false;
+		}
+		_mm_storeu_si128((__m128i*)(cells + cell), numbers);
+	}
+#endif
+
+	for (; cell < 81; cell++)
+	{
+		const char c = text[cell] == '.' ? '0' : text[cell];
+		if (c < '0' || c > '9')
+		{
+			return false;
+		}
+		cells[cell] = (uint8_t)(c - '0');
+	}
+	return true;
+}
+
+int Sudoku::PuzzleReader::parseLine(const char* line, const size_t length, uint8_t* cells)
+{
+	// Cells followed by the end of the line or a separator and a comment
+	if (length < 81 || (length > 81 && !isSeparator(line[81])) || !parseCells(line, cells))
+	{
+		return -1;
+	}
+	size_t commentStart = 81;
+	while (commentStart < length && isSeparator(line[commentStart]))
+	{
+		commentStart++;
+	}
+	return (int)commentStart;
+}
+
+bool Sudoku::PuzzleReader::next(uint8_t* cells)
+{
+	while (mPosition < mSize)
+	{
+		// Find end of line
+		const char* line = (const char*)mData + mPosition;
+		const size_t remaining = mSize - mPosition;
+		const char* newline = (const char*)memchr(line, '\n', remaining);
+		size_t length = newline != nullptr ? (size_t)(newline - line) : remaining;
+		mPosition += newline != nullptr ? length + 1 : length;
+		mLine++;
+		if (length > 0 && line[length - 1] == '\r')
+		{
+			length--;
+		}
+
+		const int commentStart = parseLine(line, length, cells);
+		if (commentStart >= 0)
+		{
+			mComment = line + commentStart;
+			mCommentLength = (int)(length - commentStart);
+			return true;
+		}
+
+		// Skip blank and comment lines quietly, and count anything else
+		if (length > 0 && line[0] != '#')
+		{
+			mSkipped++;
+		}
+	}
+	return false;
+}
+
+bool Sudoku::PuzzleReader::next(int* grid)
+{
+	uint8_t cells[81];
+	if (!next(cells))
+	{
+		return false;
+	}
+	for (int i = 0; i < 81; i++)
+	{
+		grid[i] = cells[i];
+	}
+	return true;
+}
+
+const char* Sudoku::PuzzleReader::getComment(int& length) const
+{
+	length = mCommentLength;
+	return mComment;
+}
+
+int Sudoku::PuzzleReader::getLine() const
+{
+	return mLine;
+}
+
+int Sudoku::PuzzleReader::getSkipped() const
+{
+	return mSkipped;
+}
+
+size_t Sudoku::PuzzleReader::getSize() const
+{
+	return mSize;
+}
+
+size_t Sudoku::PuzzleReader::getPosition() const
+{
+	return mPosition;
+}
+
+Sudoku::PuzzleWriter::PuzzleWriter()
+	: mFile(nullptr), mOwnsFile(false),
+	  mUsed(0), mBlank('.'),
+	  mCount(0), mFailed(false)
+{
+
+}
+
+Sudoku::PuzzleWriter::~PuzzleWriter()
+{
+	close();
+}
+
+bool Sudoku::PuzzleWriter::open(const std::string& path)
+{
+	close();
+
+	if (path == "-")
+	{
+		mFile = stdout;
+		mOwnsFile = false;
+	}
+	else
+	{
+		mFile = openFile(path.c_str(), "wb");
+		mOwnsFile = true;
+	}
+	mBuffer.resize(BUFFER_SIZE);
+	mUsed = 0;
+	mCount = 0;
+	mFailed = false;
+	return mFile != nullptr;
+}
+
+bool Sudoku::PuzzleWriter::close()
+{
+	if (mFile == nullptr)
+	{
+		return !mFailed;
+	}
+
+	flush();
+	if (mOwnsFile && fclose(mFile) != 0)
+	{
+		mFailed = true;
+	}
+	mFile = nullptr;
+	return !mFailed;
+}
+
+void Sudoku::PuzzleWriter::setBlank(const char blank)
+{
+	mBlank = blank;
+}
+
+void Sudoku::PuzzleWriter::reserve(const size_t bytes)
+{
+	if (mUsed + bytes > mBuffer.size())
+	{
+		flush();
+		if (bytes > mBuffer.size())
+		{
+			mBuffer.resize(bytes);
+		}
+	}
+}
+
+void Sudoku::PuzzleWriter::write(const uint8_t* cells, const char* comment, const int commentLength)
+{
+	if (mFile == nullptr)
+	{
+		return;
+	}
+
+	// Cells, then a space and the comment, then a newline
+	const size_t length = 81 + (commentLength > 0 ? 1 + (size_t)commentLength : 0) + 1;
+	reserve(length);
+	char* out = mBuffer.data() + mUsed;
+	for (int i = 0; i < 81; i++)
+	{
+		out[i] = cells[i] != 0 ? (char)('0' + cells[i]) : mBlank;
+	}
+	out += 81;
+	if (commentLength > 0)
+	{
+		*out++ = ' ';
+		memcpy(out, comment, (size_t)commentLength);
+		out += commentLength;
+	}
+	*out = '\n';
+	mUsed += length;
+	mCount++;
+}
+
+void Sudoku::PuzzleWriter::write(const int* grid, const char* comment, const int commentLength)
+{
+	uint8_t cells[81];
+	for (int i = 0; i < 81; i++)
+	{
+		cells[i] = grid[i] >= 0 && grid[i] <= 9 ? (uint8_t)grid[i] : 0;
+	}
+	write(cells, comment, commentLength);
+}
+
+bool Sudoku::PuzzleWriter::flush()
+{
+	if (mFile != nullptr && mUsed > 0)
+	{
+		if (fwrite(mBuffer.data(), 1, mUsed, mFile) != mUsed)
+		{
+			mFailed = true;
+		}
+		mUsed = 0;
+	}
+	return !mFailed;
+}
+
+int Sudoku::PuzzleWriter::getCount() const
+{
+	return mCount;
+}
@@ -0,0 +1,117 @@
+/* Streaming reader and writer for one-puzzle-per-line files (81 cells with 0 or . blanks and an optional comment) */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace Sudoku
+{
+	class PuzzleReader
+	{
+	private:
+		// Mapped input file and the position of the next line
+		const uint8_t* mData;
+		size_t mSize;
+		size_t mPosition;
+
+		// Comment of the last puzzle read (points into the mapped file)
+		const char* mComment;
+		int mCommentLength;
+
+		// Line number of the last puzzle read and number of malformed lines skipped (blank lines and # comment lines are not counted)
+		int mLine;
+		int mSkipped;
+
+	public:
+		// Constructor
+		PuzzleReader();
+
+		// Destructor to unmap the file
+		~PuzzleReader();
+
+		// Map a file for reading (returns false if it can't be opened; an empty file has no puzzles)
+		bool open(const std::string& path);
+
+		// Unmap the file
+		void close();
+
+		// Read the next puzzle into 81 numbers (0 for blanks), skipping malformed lines (returns false at the end of the file)
+		bool next(uint8_t* cells);
+		bool next(int* grid);
+
+		// Get comment after the cells of the last puzzle read (not terminated, may be empty)
+		const char* getComment(int& length) const;
+
+		// Get line number of the last puzzle read and number of malformed lines skipped
+		int getLine() const;
+		int getSkipped() const;
+
+		// Get size of the file and bytes read so far
+		size_t getSize() const;
+		size_t getPosition() const;
+
+		// Parse 81 cell characters into numbers (returns false if any is not 0 to 9 or .)
+		static bool parseCells(const char* text, uint8_t* cells);
+
+		// Parse a line without its line ending into numbers, returning where its comment starts (-1 if it isn't a puzzle)
+		static int parseLine(const char* line, const size_t length, uint8_t* cells);
+
+	};
+
+	class PuzzleWriter
+	{
+	public:
+		// Bytes buffered before they are written out
+		static const int BUFFER_SIZE = 1 << 20;
+
+	private:
+		// Output file (standard output is not closed)
+		FILE* mFile;
+		bool mOwnsFile;
+
+		// Buffered output
+		std::vector<char> mBuffer;
+		size_t mUsed;
+
+		// Character written for blank cells
+		char mBlank;
+
+		// Number of puzzles written and whether a write failed
+		int mCount;
+		bool mFailed;
+
+	private:
+		// Make room for a number of bytes in the buffer
+		void reserve(const size_t bytes);
+
+	public:
+		// Constructor
+		PuzzleWriter();
+
+		// Destructor to flush and close the file
+		~PuzzleWriter();
+
+		// Open a file for writing ("-" writes to standard output)
+		bool open(const std::string& path);
+
+		// Flush and close the file (returns false if any write failed)
+		bool close();
+
+		// Set character written for blank cells (0 or .)
+		void setBlank(const char blank);
+
+		// Write a puzzle of 81 numbers with an optional comment after it
+		void write(const uint8_t* cells, const char* comment = nullptr, const int commentLength = 0);
+		void write(const int* grid, const char* comment = nullptr, const int commentLength = 0);
+
+		// Write buffered bytes to the file
+		bool flush();
+
+		// Get number of puzzles written
+		int getCount() const;
+
+	};
+
+};
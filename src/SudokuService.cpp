@@ -0,0 +1,598 @@
+#include "SudokuService.h"
+#include "SudokuGenerator.h"
+#include "SudokuHintEngine.h"
+#include "SudokuPuzzleIO.h"
+#include "SudokuVariantSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include "SudokuPlatform.h"
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+#define closeSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketHandle;
+#define INVALID_SOCKET (-1)
+#define closeSocket ::close
+#endif
+
+// Don't raise SIGPIPE when a client disconnects while its answers are sent
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+namespace
+{
+	// Names of variants in GENERATE requests (in Variant order)
+	const char* const gVariantNames[] = { "classic", "diagonal", "windoku", "killer" };
+
+	// Names of grades (in HintTechnique order, then guessing)
+	const char* const gGradeNames[] = { "none", "naked", "hidden", "locked", "pair", "guess" };
+
+	// Write 81 cells to a stream
+	void writeCells(std::ostringstream& out, const int* grid)
+	{
+		char cells[82];
+		for (int i = 0; i < 81; i++)
+		{
+			cells[i] = (char)('0' + grid[i]);
+		}
+		cells[81] = '\0';
+		out << cells;
+	}
+
+	// Read 81 cells from a request argument
+	bool readCells(const std::string& text, int* grid)
+	{
+		uint8_t cells[81];
+		if (text.size() != 81 || !Sudoku::PuzzleReader::parseCells(text.c_str(), cells))
+		{
+			return false;
+		}
+		for (int i = 0; i < 81; i++)
+		{
+			grid[i] = cells[i];
+		}
+		return true;
+	}
+
+	// Generate a Sudoku of a variant within limits, returning the rules it was generated with
+	template <class Rules>
+	Sudoku::SolveStatus generateVariant(const unsigned int seed, const Sudoku::SolveLimits& limits, int* grid, int* solution, Rules& rules)
+	{
+		Sudoku::VariantGenerator<Rules> generator;
+		generator.setSeed(seed);
+		const Sudoku::SolveStatus status = generator.generate(grid, solution, limits);
+		rules = generator.getRules();
+		return status;
+	}
+
+	// Check if a request was stopped by its limits
+	bool isStopped(const Sudoku::SolveStatus status)
+	{
+		return status == Sudoku::SolveStatus::CANCELLED || status == Sudoku::SolveStatus::TIMED_OUT;
+	}
+
+	// Answer to a request stopped by its limits
+	const char* stoppedAnswer(const Sudoku::SolveStatus status)
+	{
+		return status == Sudoku::SolveStatus::TIMED_OUT ? "ERR timeout" : "ERR stopping";
+	}
+
+	// Check if the last accept failed for a reason that can pass (a client giving up, or running out of sockets until connections close)
+	bool isTransientAcceptError()
+	{
+#ifdef _WIN32
+		const int error = WSAGetLastError();
+		return error == WSAEINTR || error == WSAECONNRESET || error == WSAEWOULDBLOCK || error == WSAEMFILE || error == WSAENOBUFS;
+#else
+		const int error = errno;
+		return error == EINTR || error == ECONNABORTED || error == EAGAIN || error == EWOULDBLOCK || error == EPROTO
+			|| error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM;
+#endif
+	}
+
+	// Send all bytes to a socket
+	bool sendAll(const SocketHandle socket, const std::string& data)
+	{
+		size_t sent = 0;
+		while (sent < data.size())
+		{
+			const int result = send(socket, data.data() + sent, (int)(data.size() - sent), SEND_FLAGS);
+			if (result <= 0)
+			{
+				return false;
+			}
+			sent += (size_t)result;
+		}
+		return true;
+	}
+}
+
+Sudoku::PuzzleService::PuzzleService()
+	: mListener(-1), mStop(false), mRequestBudget(DEFAULT_REQUEST_BUDGET),
+	  mNextSeed((unsigned int)time(NULL)), mRequests(0)
+{
+
+}
+
+Sudoku::PuzzleService::~PuzzleService()
+{
+	stop();
+}
+
+bool Sudoku::PuzzleService::start(const int port, const int threads, const int requestBudget)
+{
+	mRequestBudget = requestBudget > 0 ? requestBudget : DEFAULT_REQUEST_BUDGET;
+	mCancel.reset();
+
+
+#ifdef _WIN32
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		std::cerr << "Could not start Winsock" << std::endl;
+		return false;
+	}
+#endif
+
+	// Listen on the loopback interface only
+	const SocketHandle listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (listener == INVALID_SOCKET)
+	{
+		std::cerr << "Could not create socket" << std::endl;
+		return false;
+	}
+	const int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	sockaddr_in address = { };
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons((unsigned short)port);
+	if (bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listener, MAX_CONNECTIONS) != 0)
+	{
+		std::cerr << "Could not listen on 127.0.0.1:" << port << std::endl;
+		closeSocket(listener);
+		return false;
+	}
+	mListener = (intptr_t)listener;
+	mStop = false;
+
+	// Workers answer batches, the acceptor gives every connection its own reading thread
+	const int totalWorkers = threads > 0 ? threads : 1;
+	for (int i = 0; i < totalWorkers; i++)
+	{
+		mWorkers.push_back(std::thread(&PuzzleService::runWorker, this));
+	}
+	mAcceptor = std::thread(&PuzzleService::acceptConnections, this);
+	return true;
+}
+
+void Sudoku::PuzzleService::stop()
+{
+	if (!mAcceptor.joinable())
+	{
+		return;
+	}
+	mStop = true;
+
+	// Requests being answered give up at their next check
+	mCancel.cancel();
+
+	// The acceptor stops within ACCEPT_POLL, shutting down connections wakes their threads
+	mAcceptor.join();
+	closeSocket((SocketHandle)mListener.load());
+	mListener = -1;
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+	}
+	mQueueNotFull.notify_all();
+	{
+		std::lock_guard<std::mutex> lock(mConnectionsMutex);
+		for (std::list<Connection>::iterator connection = mConnections.begin(); connection != mConnections.end(); ++connection)
+		{
+			shutdown((SocketHandle)connection->socket, 2);
+		}
+	}
+	for (std::list<Connection>::iterator connection = mConnections.begin(); connection != mConnections.end(); ++connection)
+	{
+		connection->thread.join();
+	}
+	mConnections.clear();
+
+	// Workers finish once the queue is empty
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+	}
+	mQueueNotEmpty.notify_all();
+	for (size_t i = 0; i < mWorkers.size(); i++)
+	{
+		mWorkers[i].join();
+	}
+	mWorkers.clear();
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+void Sudoku::PuzzleService::requestStop()
+{
+	// The acceptor sees the flag within ACCEPT_POLL (only the flag is touched, so this is safe in a signal handler)
+	mStop = true;
+}
+
+void Sudoku::PuzzleService::wait()
+{
+	while (!mStop)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+}
+
+int64_t Sudoku::PuzzleService::getRequests() const
+{
+	return mRequests;
+}
+
+void Sudoku::PuzzleService::acceptConnections()
+{
+	int backoff = 0;
+	while (!mStop)
+	{
+		// Wait for a connection a short time at most, so a stop is seen even where closing the listener doesn't wake accept
+		const SocketHandle listener = (SocketHandle)mListener.load();
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(listener, &readable);
+		timeval timeout = { 0, ACCEPT_POLL * 1000 };
+		const int ready = select((int)listener + 1, &readable, nullptr, nullptr, &timeout);
+		if (ready == 0 || mStop)
+		{
+			continue;
+		}
+		const SocketHandle client = ready > 0 ? accept(listener, nullptr, nullptr) : INVALID_SOCKET;
+		if (client == INVALID_SOCKET)
+		{
+			if (mStop)
+			{
+				break;
+			}
+
+			// A listener that can't accept any more stops the service, so wait returns instead of the acceptor spinning
+			if (!isTransientAcceptError())
+			{
+				std::cerr << "Stopped accepting connections after an error" << std::endl;
+				mStop = true;
+				break;
+			}
+
+			// Back off while accepting keeps failing (sockets running out only passes once connections close)
+			backoff = backoff > 0 ? std::min(backoff * 2, (int)MAX_ACCEPT_BACKOFF) : (int)ACCEPT_BACKOFF;
+			std::this_thread::sleep_for(std::chrono::milliseconds(backoff));
+			continue;
+		}
+		backoff = 0;
+
+		std::lock_guard<std::mutex> lock(mConnectionsMutex);
+
+		// Remove connections that have finished
+		for (std::list<Connection>::iterator connection = mConnections.begin(); connection != mConnections.end();)
+		{
+			if (connection->finished)
+			{
+				connection->thread.join();
+				connection = mConnections.erase(connection);
+			}
+			else
+			{
+				++connection;
+			}
+		}
+
+		if (mStop || (int)mConnections.size() >= MAX_CONNECTIONS)
+		{
+			sendAll(client, "ERR busy\n");
+			closeSocket(client);
+			continue;
+		}
+
+		mConnections.emplace_back();
+		Connection& connection = mConnections.back();
+		connection.socket = (intptr_t)client;
+		connection.thread = std::thread(&PuzzleService::serveConnection, this, &connection);
+	}
+}
+
+void Sudoku::PuzzleService::serveConnection(Connection* connection)
+{
+	const SocketHandle client = (SocketHandle)connection->socket;
+	std::string buffer;
+	char chunk[65536];
+	bool open = true;
+	while (open && !mStop)
+	{
+		// Take every complete line already received (up to a batch), so pipelined requests are answered together
+		Batch batch;
+		size_t start = 0;
+		size_t end;
+		while ((int)batch.requests.size() < MAX_BATCH && (end = buffer.find('\n', start)) != std::string::npos)
+		{
+			size_t length = end - start;
+			if (length > 0 && buffer[start + length - 1] == '\r')
+			{
+				length--;
+			}
+			batch.requests.push_back(buffer.substr(start, length));
+			start = end + 1;
+		}
+		buffer.erase(0, start);
+
+		if (!batch.requests.empty())
+		{
+			process(batch);
+			std::string responses;
+			for (size_t i = 0; i < batch.responses.size(); i++)
+			{
+				responses += batch.responses[i];
+				responses += '\n';
+			}
+			open = sendAll(client, responses);
+			continue;
+		}
+
+		// Refuse lines that never end
+		if ((int)buffer.size() > MAX_LINE)
+		{
+			sendAll(client, "ERR request too long\n");
+			break;
+		}
+
+		const int received = recv(client, chunk, sizeof(chunk), 0);
+		if (received <= 0)
+		{
+			break;
+		}
+		buffer.append(chunk, (size_t)received);
+	}
+
+	closeSocket(client);
+	connection->finished = true;
+}
+
+void Sudoku::PuzzleService::process(Batch& batch)
+{
+	std::unique_lock<std::mutex> lock(mQueueMutex);
+
+	// Wait for room in the queue; while waiting this connection isn't read, which slows the client down
+	mQueueNotFull.wait(lock, [this] { return mStop || (int)mQueue.size() < QUEUE_CAPACITY; });
+	if (mStop)
+	{
+		batch.responses.assign(batch.requests.size(), "ERR stopping");
+		return;
+	}
+	mQueue.push_back(&batch);
+	mQueueNotEmpty.notify_one();
+
+	mBatchDone.wait(lock, [&batch] { return batch.done; });
+}
+
+void Sudoku::PuzzleService::runWorker()
+{
+	while (true)
+	{
+		Batch* batch;
+		{
+			std::unique_lock<std::mutex> lock(mQueueMutex);
+			mQueueNotEmpty.wait(lock, [this] { return mStop || !mQueue.empty(); });
+			if (mQueue.empty())
+			{
+				return;
+			}
+			batch = mQueue.front();
+			mQueue.pop_front();
+		}
+		mQueueNotFull.notify_one();
+
+		// Answer the whole batch without taking the lock
+		batch->responses.resize(batch->requests.size());
+		for (size_t i = 0; i < batch->requests.size(); i++)
+		{
+			batch->responses[i] = answer(batch->requests[i]);
+		}
+		mRequests += (int64_t)batch->requests.size();
+
+		{
+			std::lock_guard<std::mutex> lock(mQueueMutex);
+			batch->done = true;
+		}
+		mBatchDone.notify_all();
+	}
+}
+
+std::string Sudoku::PuzzleService::answer(const std::string& request)
+{
+	std::istringstream in(request);
+	std::ostringstream out;
+	std::string command;
+	std::string cells;
+	in >> command;
+
+	// Every request gets the same time budget, and gives up early when the service stops
+	const SolveLimits limits = SolveLimits::budget((double)mRequestBudget, &mCancel);
+
+	if (command == "PING")
+	{
+		return "OK";
+	}
+
+	if (command == "SOLVE" || command == "COUNT" || command == "GRADE")
+	{
+		int grid[81];
+		in >> cells;
+		if (!readCells(cells, grid))
+		{
+			return "ERR expected 81 cells";
+		}
+
+		VariantSolver<ClassicRules> solver;
+		if (!solver.setGrid(grid))
+		{
+			return command == "COUNT" ? "OK 0" : "NONE";
+		}
+
+		if (command == "SOLVE")
+		{
+			int solution[81];
+			if (!solver.solve(solution, limits))
+			{
+				return isStopped(solver.getStatus()) ? stoppedAnswer(solver.getStatus()) : "NONE";
+			}
+			out << "OK ";
+			writeCells(out, solution);
+			return out.str();
+		}
+
+		if (command == "COUNT")
+		{
+			// The limit is optional, but one that isn't a number is an error rather than a default
+			std::string limitText;
+			int limit = 2;
+			if (in >> limitText)
+			{
+				char* end;
+				const long parsed = strtol(limitText.c_str(), &end, 10);
+				if (*end != '\0')
+				{
+					return "ERR bad limit";
+				}
+				limit = parsed < 1 ? 1 : (parsed > 1000000 ? 1000000 : (int)parsed);
+			}
+			const int solutions = solver.countSolutions(limit, limits);
+			if (isStopped(solver.getStatus()))
+			{
+				return stoppedAnswer(solver.getStatus());
+			}
+			out << "OK " << solutions;
+			return out.str();
+		}
+
+		// Grade by the hardest technique needed to fill the grid with hints, or guessing if hints get stuck
+		const int solutions = solver.countSolutions(2, limits);
+		if (isStopped(solver.getStatus()))
+		{
+			return stoppedAnswer(solver.getStatus());
+		}
+		if (solutions != 1)
+		{
+			return "ERR not a unique puzzle";
+		}
+		int grade = 0;
+		int placements = 0;
+		SolveStatus status;
+		while (true)
+		{
+			if (limits.reached(status))
+			{
+				return stoppedAnswer(status);
+			}
+			const Hint hint = HintEngine::findHint(grid);
+			if (hint.index < 0)
+			{
+				bool filled = true;
+				for (int i = 0; i < 81 && filled; i++)
+				{
+					filled = grid[i] != 0;
+				}
+				grade = filled ? grade : 5;
+				break;
+			}
+			grade = (int)hint.technique > grade ? (int)hint.technique : grade;
+			grid[hint.index] = hint.num;
+			placements++;
+		}
+		out << "OK " << gGradeNames[grade] << " " << placements;
+		return out.str();
+	}
+
+	if (command == "GENERATE")
+	{
+		std::string variantName = "classic";
+		in >> variantName;
+		unsigned int seed;
+		if (!(in >> seed))
+		{
+			seed = mNextSeed++;
+		}
+
+		int variant = -1;
+		for (int i = 0; i < (int)Variant::TOTAL_VARIANTS; i++)
+		{
+			variant = variantName == gVariantNames[i] ? i : variant;
+		}
+		if (variant < 0)
+		{
+			return "ERR unknown variant";
+		}
+
+		int grid[81] = { };
+		int solution[81] = { };
+		KillerRules cages;
+		SolveStatus status;
+		if ((Variant)variant == Variant::DIAGONAL)
+		{
+			DiagonalRules rules;
+			status = generateVariant(seed, limits, grid, solution, rules);
+		}
+		else if ((Variant)variant == Variant::WINDOKU)
+		{
+			WindokuRules rules;
+			status = generateVariant(seed, limits, grid, solution, rules);
+		}
+		else if ((Variant)variant == Variant::KILLER)
+		{
+			status = generateVariant(seed, limits, grid, solution, cages);
+		}
+		else
+		{
+			Generator generator;
+			generator.setSeed(seed);
+			status = generator.generate(grid, solution, limits);
+		}
+		if (isStopped(status))
+		{
+			return stoppedAnswer(status);
+		}
+
+		out << "OK ";
+		writeCells(out, grid);
+		out << " ";
+		writeCells(out, solution);
+		if ((Variant)variant == Variant::KILLER)
+		{
+			const char* const hex = "0123456789abcdef";
+			out << " ";
+			for (int i = 0; i < 81; i++)
+			{
+				out << hex[cages.cageOf[i] >> 4] << hex[cages.cageOf[i] & 0xF];
+			}
+		}
+		return out.str();
+	}
+
+	return "ERR unknown request";
+}
@@ -0,0 +1,136 @@
+/* Headless puzzle service answering solve, count, grade and generate requests over localhost TCP */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SudokuSolveLimits.h"
+
+namespace Sudoku
+{
+	// Protocol: one request per line, answered by one line in the same order.
+	//   PING                                      -> OK
+	//   SOLVE <81 cells>                          -> OK <81 cells> | NONE
+	//   COUNT <81 cells> [limit]                  -> OK <solutions up to the limit (default 2)>
+	//   GRADE <81 cells>                          -> OK <naked|hidden|locked|pair|guess> <placements deduced>
+	//   GENERATE [classic|diagonal|windoku|killer] [seed]
+	//                                             -> OK <puzzle> <solution> [<cage of every cell as 2 hex digits>]
+	// Cells are 1 to 9 with 0 or . for blanks. Errors are answered with ERR <reason>, and requests
+	// that run past the request budget are answered with ERR timeout.
+	class PuzzleService
+	{
+	public:
+		// Requests read from one connection at once and answered together
+		static const int MAX_BATCH = 256;
+
+		// Batches waiting for a worker before connections stop being read (backpressure)
+		static const int QUEUE_CAPACITY = 64;
+
+		// Connections served at once (more are refused with ERR busy)
+		static const int MAX_CONNECTIONS = 64;
+
+		// Longest request line accepted
+		static const int MAX_LINE = 1024;
+
+		// Time a request may take by default (milliseconds)
+		static const int DEFAULT_REQUEST_BUDGET = 1000;
+
+		// Longest wait for a connection before the acceptor checks for a stop (milliseconds)
+		static const int ACCEPT_POLL = 100;
+
+		// Wait after a failed accept, doubled while accepting keeps failing (milliseconds)
+		static const int ACCEPT_BACKOFF = 10;
+		static const int MAX_ACCEPT_BACKOFF = 500;
+
+	private:
+		// Requests of one connection processed together by one worker
+		struct Batch
+		{
+			std::vector<std::string> requests;
+			std::vector<std::string> responses;
+			bool done = false;
+		};
+
+		// Connection thread and its socket
+		struct Connection
+		{
+			std::thread thread;
+			intptr_t socket = -1;
+			std::atomic<bool> finished;
+
+			Connection() : finished(false) { }
+		};
+
+		// Listening socket and the thread accepting connections
+		std::atomic<intptr_t> mListener;
+		std::thread mAcceptor;
+		std::atomic<bool> mStop;
+
+		// Open connections (finished ones are removed as new ones are accepted)
+		std::mutex mConnectionsMutex;
+		std::list<Connection> mConnections;
+
+		// Worker threads and the bounded queue of batches
+		std::vector<std::thread> mWorkers;
+		std::mutex mQueueMutex;
+		std::condition_variable mQueueNotEmpty;
+		std::condition_variable mQueueNotFull;
+		std::condition_variable mBatchDone;
+		std::deque<Batch*> mQueue;
+
+		// Time budget of every request (milliseconds) and the token cancelling requests when the service stops
+		int mRequestBudget;
+		CancelToken mCancel;
+
+		// Seed for GENERATE requests without one
+		std::atomic<unsigned int> mNextSeed;
+
+		// Number of requests answered
+		std::atomic<int64_t> mRequests;
+
+	private:
+		// Accept connections until stopped, backing off while accepting fails and stopping the service if the listener fails for good
+		void acceptConnections();
+
+		// Read batches of requests from a connection and write their responses
+		void serveConnection(Connection* connection);
+
+		// Worker loop answering batches
+		void runWorker();
+
+		// Queue a batch for the workers and wait until it is answered
+		void process(Batch& batch);
+
+		// Answer one request
+		std::string answer(const std::string& request);
+
+	public:
+		// Constructor
+		PuzzleService();
+
+		// Destructor to stop the service
+		~PuzzleService();
+
+		// Listen on 127.0.0.1 at a port and start worker threads with a time budget per request (returns false if the port can't be opened)
+		bool start(const int port, const int threads, const int requestBudget = DEFAULT_REQUEST_BUDGET);
+
+		// Stop accepting, close connections and stop the workers
+		void stop();
+
+		// Ask the service to stop, so wait returns (safe to call from a signal handler; stop does the rest)
+		void requestStop();
+
+		// Wait until the service stops or is asked to
+		void wait();
+
+		// Get number of requests answered
+		int64_t getRequests() const;
+
+	};
+
+};
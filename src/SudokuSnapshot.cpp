@@ -0,0 +1,248 @@
+#include "SudokuSnapshot.h"
+#include "SudokuPlatform.h"
+
+namespace
+{
+	// File magic and format version
+	const uint8_t SNAPSHOT_MAGIC[4] = { 'S', 'D', 'K', 'S' };
+	const uint8_t SNAPSHOT_VERSION = 2;
+
+	// Little-endian 32-bit integers
+	void writeU32(uint8_t* bytes, const uint32_t value)
+	{
+		bytes[0] = (uint8_t)value;
+		bytes[1] = (uint8_t)(value >> 8);
+		bytes[2] = (uint8_t)(value >> 16);
+		bytes[3] = (uint8_t)(value >> 24);
+	}
+
+	uint32_t readU32(const uint8_t* bytes)
+	{
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+
+	// FNV-1a checksum
+	uint32_t checksum(const uint8_t* bytes, const int size)
+	{
+		uint32_t hash = 2166136261u;
+		for (int i = 0; i < size; i++)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+		return hash;
+	}
+
+	// Pack 81 numbers from 0 to 9 into 41 bytes (two per byte)
+	void packNibbles(const uint8_t* values, uint8_t* bytes)
+	{
+		for (int i = 0; i < 41; i++)
+		{
+			const uint8_t low = values[2 * i];
+			const uint8_t high = 2 * i + 1 < 81 ? values[2 * i + 1] : 0;
+			bytes[i] = (uint8_t)(low | (high << 4));
+		}
+	}
+
+	bool unpackNibbles(const uint8_t* bytes, uint8_t* values)
+	{
+		for (int i = 0; i < 81; i++)
+		{
+			values[i] = (bytes[i / 2] >> ((i % 2) * 4)) & 0xF;
+			if (values[i] > 9)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Pack 81 values of a given bit width into a bit stream
+	void packBits(const uint16_t* values, const int bits, uint8_t* bytes, const int size)
+	{
+		for (int i = 0; i < size; i++)
+		{
+			bytes[i] = 0;
+		}
+		for (int i = 0; i < 81; i++)
+		{
+			for (int bit = 0; bit < bits; bit++)
+			{
+				if (values[i] & (1u << bit))
+				{
+					const int position = i * bits + bit;
+					bytes[position / 8] |= (uint8_t)(1u << (position % 8));
+				}
+			}
+		}
+	}
+
+	void unpackBits(const uint8_t* bytes, const int bits, uint16_t* values)
+	{
+		for (int i = 0; i < 81; i++)
+		{
+			values[i] = 0;
+			for (int bit = 0; bit < bits; bit++)
+			{
+				const int position = i * bits + bit;
+				if (bytes[position / 8] & (1u << (position % 8)))
+				{
+					values[i] |= (uint16_t)(1u << bit);
+				}
+			}
+		}
+	}
+}
+
+void Sudoku::encodeSnapshot(const Snapshot& snapshot, uint8_t* bytes)
+{
+	uint8_t* out = bytes;
+
+	// Header
+	for (int i = 0; i < 4; i++)
+	{
+		*out++ = SNAPSHOT_MAGIC[i];
+	}
+	*out++ = SNAPSHOT_VERSION;
+	writeU32(out, snapshot.seed);
+	out += 4;
+	writeU32(out, snapshot.elapsedSeconds);
+	out += 4;
+
+	// Givens as an 81-bit mask
+	uint16_t givens[81];
+	for (int i = 0; i < 81; i++)
+	{
+		givens[i] = snapshot.givens[i] ? 1 : 0;
+	}
+	packBits(givens, 1, out, 11);
+	out += 11;
+
+	// Values and solution as nibbles
+	packNibbles(snapshot.values, out);
+	out += 41;
+	packNibbles(snapshot.solution, out);
+	out += 41;
+
+	// Notes as 9 bits per cell
+	packBits(snapshot.notes, 9, out, 92);
+	out += 92;
+
+	// Variant and cages
+	*out++ = snapshot.variant;
+	for (int i = 0; i < 81; i++)
+	{
+		*out++ = snapshot.cages[i];
+	}
+
+	// Checksum of everything before it
+	writeU32(out, checksum(bytes, (int)(out - bytes)));
+}
+
+bool Sudoku::decodeSnapshot(const uint8_t* bytes, const int size, Snapshot& snapshot)
+{
+	if (size < SNAPSHOT_SIZE_V1)
+	{
+		return false;
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		if (bytes[i] != SNAPSHOT_MAGIC[i])
+		{
+			return false;
+		}
+	}
+	const int version = bytes[4];
+	const int expectedSize = version == 1 ? SNAPSHOT_SIZE_V1 : SNAPSHOT_SIZE;
+	if (version < 1 || version > SNAPSHOT_VERSION || size != expectedSize || readU32(bytes + size - 4) != checksum(bytes, size - 4))
+	{
+		return false;
+	}
+
+	const uint8_t* in = bytes + 5;
+	snapshot.seed = readU32(in);
+	in += 4;
+	snapshot.elapsedSeconds = readU32(in);
+	in += 4;
+
+	uint16_t givens[81];
+	unpackBits(in, 1, givens);
+	for (int i = 0; i < 81; i++)
+	{
+		snapshot.givens[i] = givens[i] != 0;
+	}
+	in += 11;
+
+	if (!unpackNibbles(in, snapshot.values))
+	{
+		return false;
+	}
+	in += 41;
+	if (!unpackNibbles(in, snapshot.solution))
+	{
+		return false;
+	}
+	in += 41;
+
+	unpackBits(in, 9, snapshot.notes);
+	in += 92;
+
+	// Version 1 snapshots are classic games
+	snapshot.variant = 0;
+	for (int i = 0; i < 81; i++)
+	{
+		snapshot.cages[i] = 0;
+	}
+	if (version >= 2)
+	{
+		snapshot.variant = *in++;
+		for (int i = 0; i < 81; i++)
+		{
+			snapshot.cages[i] = *in++;
+			if (snapshot.cages[i] >= 81)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool Sudoku::writeSnapshotFile(const std::string& path, const Snapshot& snapshot)
+{
+	uint8_t bytes[SNAPSHOT_SIZE];
+	encodeSnapshot(snapshot, bytes);
+
+	// Write and flush temporary file to storage
+	const std::string temporaryPath = path + ".tmp";
+	FILE* file = openFile(temporaryPath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+	bool success = fwrite(bytes, 1, SNAPSHOT_SIZE, file) == SNAPSHOT_SIZE && syncFile(file);
+	success = fclose(file) == 0 && success;
+	if (!success)
+	{
+		remove(temporaryPath.c_str());
+		return false;
+	}
+
+	// Atomically replace previous snapshot
+	return replaceFile(temporaryPath.c_str(), path.c_str());
+}
+
+bool Sudoku::readSnapshotFile(const std::string& path, Snapshot& snapshot)
+{
+	FILE* file = openFile(path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	// Read one byte more than expected to reject files of the wrong size
+	uint8_t bytes[SNAPSHOT_SIZE + 1];
+	const int size = (int)fread(bytes, 1, sizeof(bytes), file);
+	fclose(file);
+
+	return decodeSnapshot(bytes, size, snapshot);
+}
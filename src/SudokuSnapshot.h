@@ -0,0 +1,45 @@
+/* Compact binary snapshot of a game in progress */
+#pragma once
+#include <stdint.h>
+#include <string>
+
+namespace Sudoku
+{
+	struct Snapshot
+	{
+		// Seed the puzzle was generated from
+		uint32_t seed = 0;
+
+		// Seconds played so far
+		uint32_t elapsedSeconds = 0;
+
+		// Givens are fixed cells, values are givens and entries (0 = empty), solution may be all 0 for imported puzzles
+		bool givens[81] = { };
+		uint8_t values[81] = { };
+		uint8_t solution[81] = { };
+
+		// Pencil mark candidates of each cell (bit 0 = number 1)
+		uint16_t notes[81] = { };
+
+		// Variant being played (see Variant) and the killer cage of each cell
+		uint8_t variant = 0;
+		uint8_t cages[81] = { };
+	};
+
+	// Size of an encoded snapshot in bytes (version 1 snapshots have no variant or cages and are still read)
+	const int SNAPSHOT_SIZE_V1 = 4 + 1 + 4 + 4 + 11 + 41 + 41 + 92 + 4;
+	const int SNAPSHOT_SIZE = SNAPSHOT_SIZE_V1 + 1 + 81;
+
+	// Encode snapshot into SNAPSHOT_SIZE bytes
+	void encodeSnapshot(const Snapshot& snapshot, uint8_t* bytes);
+
+	// Decode snapshot, returning false if the bytes are not a valid snapshot
+	bool decodeSnapshot(const uint8_t* bytes, const int size, Snapshot& snapshot);
+
+	// Write snapshot to a temporary file and rename it over the path so a crash never leaves a partial file
+	bool writeSnapshotFile(const std::string& path, const Snapshot& snapshot);
+
+	// Read snapshot from a file
+	bool readSnapshotFile(const std::string& path, Snapshot& snapshot);
+
+};
@@ -0,0 +1,85 @@
+/* Cancellation tokens and deadlines for solve and generate calls */
+#pragma once
+#include <atomic>
+#include <chrono>
+
+namespace Sudoku
+{
+	// Result of a solve or generate call
+	enum class SolveStatus
+	{
+		SOLVED = 0,
+		NO_SOLUTION = 1,
+		CANCELLED = 2,
+		TIMED_OUT = 3
+	};
+
+	// Shared flag another thread sets to stop a call early
+	class CancelToken
+	{
+	private:
+		std::atomic<bool> mCancelled;
+
+	public:
+		CancelToken()
+			: mCancelled(false)
+		{
+
+		}
+
+		// Ask calls using this token to stop
+		void cancel()
+		{
+			mCancelled.store(true, std::memory_order_relaxed);
+		}
+
+		// Clear the flag so the token can be used again
+		void reset()
+		{
+			mCancelled.store(false, std::memory_order_relaxed);
+		}
+
+		bool isCancelled() const
+		{
+			return mCancelled.load(std::memory_order_relaxed);
+		}
+	};
+
+	// Limits a call checks every CHECK_INTERVAL search nodes (no token and no deadline means no limits)
+	struct SolveLimits
+	{
+		// Search nodes between checks, so the clock and token cost next to nothing
+		static const unsigned int CHECK_INTERVAL = 4096;
+
+		const CancelToken* token = nullptr;
+		bool hasDeadline = false;
+		std::chrono::steady_clock::time_point deadline;
+
+		// Limits with a time budget from now (milliseconds) and an optional token
+		static SolveLimits budget(const double milliseconds, const CancelToken* cancelToken = nullptr)
+		{
+			SolveLimits limits;
+			limits.token = cancelToken;
+			limits.hasDeadline = true;
+			limits.deadline = std::chrono::steady_clock::now() + std::chrono::microseconds((long long)(milliseconds * 1000.0));
+			return limits;
+		}
+
+		// Check if the call has to stop, setting the status it stops with
+		bool reached(SolveStatus& status) const
+		{
+			if (token != nullptr && token->isCancelled())
+			{
+				status = SolveStatus::CANCELLED;
+				return true;
+			}
+			if (hasDeadline && std::chrono::steady_clock::now() >= deadline)
+			{
+				status = SolveStatus::TIMED_OUT;
+				return true;
+			}
+			return false;
+		}
+	};
+
+};
@@ -1,7 +1,7 @@
 #include "SudokuSolver.h"
 
 Sudoku::Solver::Solver()
-	: mGrid(nullptr), mGenModifier(false), mNumToIgnore({ 0, 0, 0 })
+	: mGrid(nullptr), mGenModifier(false), mNumToIgnore({ 0, 0, 0 }), mStatus(SolveStatus::NO_SOLUTION), mNodesUntilCheck(SolveLimits::CHECK_INTERVAL)
 {
 
 }
@@ -16,9 +16,10 @@ inline int Sudoku::Solver::getElement(const int row, const int col) const
 	return mGrid[row * 9 + col];
 }
 
-bool Sudoku::Solver::checkValid(const int inputRow, const int inputCol, const int num) const
+bool Sudoku::Solver::checkValid(const int inputRow, const int inputCol, const int num)
 {
 	// if number is valid i.e. not found in row, col, or block then return true
+	SUDOKU_STAT(mStats.propagations++);
 
 	// check row
 	for (int col = 0; col < 9; col++)
@@ -73,6 +74,32 @@ void Sudoku::Solver::setGrid(int* grid, const Ignore& ignoreInput)
 
 bool Sudoku::Solver::solve()
 {
+	return solve(SolveLimits()) == SolveStatus::SOLVED;
+}
+
+Sudoku::SolveStatus Sudoku::Solver::solve(const SolveLimits& limits)
+{
+	mLimits = limits;
+	mStatus = SolveStatus::NO_SOLUTION;
+
+	// Reset statistics and time the whole search
+	SUDOKU_STAT(mStats.reset());
+	SUDOKU_STAT(mStats.solves = 1);
+	SUDOKU_STAT(SolverStopwatch stopwatch);
+
+	if (solveRecursive(0))
+	{
+		mStatus = SolveStatus::SOLVED;
+	}
+
+	SUDOKU_STAT(mStats.wallTime = stopwatch.elapsed());
+	return mStatus;
+}
+
+bool Sudoku::Solver::solveRecursive(const int depth)
+{
+	SUDOKU_STAT(mStats.maxDepth = depth > mStats.maxDepth ? depth : mStats.maxDepth);
+
 	for (int row = 0; row < 9; row++)
 	{
 		for (int col = 0; col < 9; col++)
@@ -87,14 +114,32 @@ bool Sudoku::Solver::solve()
 						// if number is valid i.e. not found in row, col, or block then return true
 						if (checkValid(row, col, num))
 						{
+							// Check the limits every few thousand nodes (the count carries over between solves)
+							if (--mNodesUntilCheck == 0)
+							{
+								mNodesUntilCheck = SolveLimits::CHECK_INTERVAL;
+								if (mLimits.reached(mStatus))
+								{
+									return false;
+								}
+							}
+
 							setElement(row, col, num);
+							SUDOKU_STAT(mStats.nodes++);
 
-							if (solve())
+							if (solveRecursive(depth + 1))
 							{
 								return true;
 							}
 							// set element to 0 since num did not work for further recursion call(s)
 							setElement(row, col, 0);
+
+							// Unwind without trying other numbers once stopped
+							if (mStatus != SolveStatus::NO_SOLUTION)
+							{
+								return false;
+							}
+							SUDOKU_STAT(mStats.backtracks++);
 						}
 					}
 				}
@@ -107,6 +152,11 @@ bool Sudoku::Solver::solve()
 	return true;
 }
 
+const Sudoku::SolverStats& Sudoku::Solver::getStats() const
+{
+	return mStats;
+}
+
 void Sudoku::Solver::display() const
 {
 	for (int row = 0; row < 9; row++)
@@ -1,5 +1,7 @@
 #pragma once
 #include <iostream>
+#include "SudokuSolveLimits.h"
+#include "SudokuSolverStats.h"
 
 namespace Sudoku 
 {
@@ -22,13 +24,24 @@ namespace Sudoku
 		bool mGenModifier;
 		Ignore mNumToIgnore;
 
+		// Statistics of the last solve (only recorded when SUDOKU_SOLVER_STATS is defined)
+		SolverStats mStats;
+
+		// Limits of the current solve, its status and the nodes left until the limits are checked again
+		SolveLimits mLimits;
+		SolveStatus mStatus;
+		unsigned int mNodesUntilCheck;
+
 	private:
 		// Set and get element of 1D array using row and col
 		inline void setElement(const int row, const int col, const int num);
 		inline int getElement(const int row, const int col) const;
 
 		// Check if element is valid for its row, col, and the block of 3 x 3 its in
-		bool checkValid(const int inputRow, const int inputCol, const int num) const;
+		bool checkValid(const int inputRow, const int inputCol, const int num);
+
+		// Backtracking search from the given recursion depth
+		bool solveRecursive(const int depth);
 
 	public:
 		// Constructor
@@ -43,6 +56,12 @@ namespace Sudoku
 		// Solve Sudoku with backtracking
 		bool solve();
 
+		// Solve Sudoku with backtracking until cancelled or past the deadline (the grid is left as it was unless solved)
+		SolveStatus solve(const SolveLimits& limits);
+
+		// Get statistics of the last solve, partial if it was stopped (all zero unless SUDOKU_SOLVER_STATS is defined)
+		const SolverStats& getStats() const;
+
 		// Display Sudoku to console (for debugging)
 		void display() const;
 
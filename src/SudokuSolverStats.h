@@ -0,0 +1,71 @@
+/* Solver statistics, recorded only when SUDOKU_SOLVER_STATS is defined */
+#pragma once
+#include <chrono>
+
+// Define SUDOKU_SOLVER_STATS in the project preprocessor definitions to record solver statistics.
+// When it is not defined every SUDOKU_STAT statement is compiled out.
+#ifdef SUDOKU_SOLVER_STATS
+#define SUDOKU_STAT(statement) statement
+#else
+#define SUDOKU_STAT(statement)
+#endif
+
+namespace Sudoku
+{
+	struct SolverStats
+	{
+		// Number of solve calls aggregated into these statistics
+		unsigned long long solves = 0;
+
+		// Search nodes visited (numbers placed) and placements undone
+		unsigned long long nodes = 0;
+		unsigned long long backtracks = 0;
+
+		// Constraint checks and propagation steps
+		unsigned long long propagations = 0;
+
+		// Deepest recursion reached
+		int maxDepth = 0;
+
+		// Wall time in milliseconds
+		double wallTime = 0.0;
+
+		// Clear all counters
+		void reset()
+		{
+			*this = SolverStats();
+		}
+
+		// Add counters of another solve (max depth is the maximum of both)
+		void add(const SolverStats& other)
+		{
+			solves += other.solves;
+			nodes += other.nodes;
+			backtracks += other.backtracks;
+			propagations += other.propagations;
+			maxDepth = other.maxDepth > maxDepth ? other.maxDepth : maxDepth;
+			wallTime += other.wallTime;
+		}
+	};
+
+	// Measures wall time of a solve into its statistics
+	class SolverStopwatch
+	{
+	private:
+		std::chrono::steady_clock::time_point mStart;
+
+	public:
+		SolverStopwatch()
+			: mStart(std::chrono::steady_clock::now())
+		{
+
+		}
+
+		// Milliseconds since construction
+		double elapsed() const
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart).count();
+		}
+	};
+
+};
@@ -0,0 +1,313 @@
+/* Resumable bitmask solver with an explicit stack, advanced a few nodes at a time (see SudokuVariants.h for rules) */
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "SudokuSolveLimits.h"
+#include "SudokuSolverStats.h"
+#include "SudokuVariants.h"
+
+namespace Sudoku
+{
+	// A number placed in or removed from a cell while stepping
+	struct StepEvent
+	{
+		enum Type : uint8_t
+		{
+			PLACE = 0,
+			REMOVE = 1
+		};
+
+		Type type = PLACE;
+		uint8_t cell = 0;
+		uint8_t num = 0;
+	};
+
+	template <class Rules>
+	class StepSolver
+	{
+	private:
+		// Cell filled at one depth, the candidates not tried yet and the number placed (0 if none)
+		struct Frame
+		{
+			int cell = 0;
+			uint16_t remaining = 0;
+			int num = 0;
+		};
+
+		// Grid being solved and the numbers used in every row, col and block (bit 0 = number 1)
+		int mGrid[81];
+		uint16_t mRowMasks[9];
+		uint16_t mColMasks[9];
+		uint16_t mBlockMasks[9];
+
+		// Extra constraints of the variant
+		Rules mRules;
+
+		// Search stack in place of recursion, so the search can stop after any node and carry on later
+		Frame mStack[81];
+		int mDepth;
+
+		// Whether the search has finished and how
+		bool mFinished;
+		SolveStatus mStatus;
+
+		// Placements and removals of the last step call
+		std::vector<StepEvent> mEvents;
+
+		// Statistics of the search so far (only recorded when SUDOKU_SOLVER_STATS is defined)
+		SolverStats mStats;
+
+	private:
+		// Get candidates of an empty cell
+		inline uint16_t getCandidates(const int cell) const;
+
+		// Place and remove a number, keeping masks and rules up to date and recording the event
+		inline void place(const int cell, const int num);
+		inline void remove(const int cell, const int num);
+
+		// Push the empty cell with the fewest candidates onto the stack (returns false if the grid is full)
+		bool pushFrame();
+
+	public:
+		// Constructor
+		StepSolver();
+
+		// Get rules to set puzzle-specific constraints (such as killer cages) before setting the grid
+		Rules& getRules();
+
+		// Set grid to solve (0 for empty cells) and restart the search, returning false if the givens already break a rule
+		bool setGrid(const int* grid);
+
+		// Advance the search by up to a number of placements, returning true once it has finished
+		bool step(const int nodes);
+
+		// Check if the search has finished, and get its status (SOLVED or NO_SOLUTION once finished)
+		bool isFinished() const;
+		SolveStatus getStatus() const;
+
+		// Get grid as the search left it (the solution once solved)
+		const int* getGrid() const;
+
+		// Get placements and removals made by the last step call, in order
+		const std::vector<StepEvent>& getEvents() const;
+
+		// Get statistics of the search so far (all zero unless SUDOKU_SOLVER_STATS is defined)
+		const SolverStats& getStats() const;
+
+	};
+
+};
+
+template <class Rules>
+Sudoku::StepSolver<Rules>::StepSolver()
+	: mGrid(), mRowMasks(), mColMasks(), mBlockMasks(),
+	  mDepth(0), mFinished(true), mStatus(SolveStatus::NO_SOLUTION)
+{
+
+}
+
+template <class Rules>
+inline uint16_t Sudoku::StepSolver<Rules>::getCandidates(const int cell) const
+{
+	const int row = cell / 9;
+	const int col = cell % 9;
+	return (uint16_t)~(mRowMasks[row] | mColMasks[col] | mBlockMasks[(row / 3) * 3 + col / 3]) & 0x1FF & mRules.allowed(cell);
+}
+
+template <class Rules>
+inline void Sudoku::StepSolver<Rules>::place(const int cell, const int num)
+{
+	const int row = cell / 9;
+	const int col = cell % 9;
+	const uint16_t bit = (uint16_t)(1u << (num - 1));
+	mGrid[cell] = num;
+	mRowMasks[row] |= bit;
+	mColMasks[col] |= bit;
+	mBlockMasks[(row / 3) * 3 + col / 3] |= bit;
+	mRules.place(cell, num);
+
+	StepEvent event;
+	event.type = StepEvent::PLACE;
+	event.cell = (uint8_t)cell;
+	event.num = (uint8_t)num;
+	mEvents.push_back(event);
+}
+
+template <class Rules>
+inline void Sudoku::StepSolver<Rules>::remove(const int cell, const int num)
+{
+	const int row = cell / 9;
+	const int col = cell % 9;
+	const uint16_t bit = (uint16_t)~(1u << (num - 1));
+	mGrid[cell] = 0;
+	mRowMasks[row] &= bit;
+	mColMasks[col] &= bit;
+	mBlockMasks[(row / 3) * 3 + col / 3] &= bit;
+	mRules.remove(cell, num);
+
+	StepEvent event;
+	event.type = StepEvent::REMOVE;
+	event.cell = (uint8_t)cell;
+	event.num = (uint8_t)num;
+	mEvents.push_back(event);
+}
+
+template <class Rules>
+bool Sudoku::StepSolver<Rules>::pushFrame()
+{
+	// Find the empty cell with the fewest candidates (one with none is pushed too if found first, and is backtracked from next)
+	int bestCell = -1;
+	int bestCount = 10;
+	uint16_t bestCandidates = 0;
+	for (int cell = 0; cell < 81 && bestCount > 1; cell++)
+	{
+		if (mGrid[cell] != 0)
+		{
+			continue;
+		}
+		const uint16_t candidates = getCandidates(cell);
+		SUDOKU_STAT(mStats.propagations++);
+		int count = 0;
+		for (uint16_t bits = candidates; bits != 0; bits &= bits - 1)
+		{
+			count++;
+		}
+		if (count < bestCount)
+		{
+			bestCell = cell;
+			bestCount = count;
+			bestCandidates = candidates;
+		}
+	}
+	if (bestCell < 0)
+	{
+		return false;
+	}
+
+	Frame& frame = mStack[mDepth++];
+	frame.cell = bestCell;
+	frame.remaining = bestCandidates;
+	frame.num = 0;
+	SUDOKU_STAT(mStats.maxDepth = mDepth > mStats.maxDepth ? mDepth : mStats.maxDepth);
+	return true;
+}
+
+template <class Rules>
+Rules& Sudoku::StepSolver<Rules>::getRules()
+{
+	return mRules;
+}
+
+template <class Rules>
+bool Sudoku::StepSolver<Rules>::setGrid(const int* grid)
+{
+	for (int i = 0; i < 9; i++)
+	{
+		mRowMasks[i] = 0;
+		mColMasks[i] = 0;
+		mBlockMasks[i] = 0;
+	}
+	mRules.reset();
+	SUDOKU_STAT(mStats.reset());
+	SUDOKU_STAT(mStats.solves = 1);
+
+	bool valid = true;
+	for (int cell = 0; cell < 81; cell++)
+	{
+		mGrid[cell] = 0;
+	}
+	for (int cell = 0; cell < 81; cell++)
+	{
+		const int num = grid[cell];
+		if (num >= 1 && num <= 9)
+		{
+			valid = valid && (getCandidates(cell) & (1u << (num - 1))) != 0;
+			place(cell, num);
+		}
+	}
+	mEvents.clear();
+
+	// A full grid is already solved, a broken one has no solution
+	mDepth = 0;
+	mFinished = !valid || !pushFrame();
+	mStatus = valid && mFinished ? SolveStatus::SOLVED : SolveStatus::NO_SOLUTION;
+	return valid;
+}
+
+template <class Rules>
+bool Sudoku::StepSolver<Rules>::step(const int nodes)
+{
+	mEvents.clear();
+	int placed = 0;
+	while (!mFinished && placed < nodes)
+	{
+		Frame& frame = mStack[mDepth - 1];
+
+		// Take back the number tried last at this depth
+		if (frame.num != 0)
+		{
+			remove(frame.cell, frame.num);
+			frame.num = 0;
+			SUDOKU_STAT(mStats.backtracks++);
+		}
+
+		// Backtrack once every candidate was tried
+		if (frame.remaining == 0)
+		{
+			mDepth--;
+			mFinished = mDepth == 0;
+			continue;
+		}
+
+		// Try the lowest candidate left
+		const uint16_t bit = frame.remaining & (uint16_t)(0u - frame.remaining);
+		frame.remaining &= (uint16_t)~bit;
+		int num = 1;
+		while (!(bit & (1u << (num - 1))))
+		{
+			num++;
+		}
+		place(frame.cell, num);
+		frame.num = num;
+		placed++;
+		SUDOKU_STAT(mStats.nodes++);
+
+		// Solution found once there is no empty cell left
+		if (!pushFrame())
+		{
+			mFinished = true;
+			mStatus = SolveStatus::SOLVED;
+		}
+	}
+	return mFinished;
+}
+
+template <class Rules>
+bool Sudoku::StepSolver<Rules>::isFinished() const
+{
+	return mFinished;
+}
+
+template <class Rules>
+Sudoku::SolveStatus Sudoku::StepSolver<Rules>::getStatus() const
+{
+	return mStatus;
+}
+
+template <class Rules>
+const int* Sudoku::StepSolver<Rules>::getGrid() const
+{
+	return mGrid;
+}
+
+template <class Rules>
+const std::vector<Sudoku::StepEvent>& Sudoku::StepSolver<Rules>::getEvents() const
+{
+	return mEvents;
+}
+
+template <class Rules>
+const Sudoku::SolverStats& Sudoku::StepSolver<Rules>::getStats() const
+{
+	return mStats;
+}
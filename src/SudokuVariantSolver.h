@@ -0,0 +1,435 @@
+/* Bitmask backtracking solver and generator templated on a rules policy (see SudokuVariants.h) */
+#pragma once
+#include <random>
+#include <stdint.h>
+#include "SudokuSolveLimits.h"
+#include "SudokuSolverStats.h"
+#include "SudokuVariants.h"
+
+namespace Sudoku
+{
+	template <class Rules>
+	class VariantSolver
+	{
+	private:
+		// Grid being solved and the numbers used in every row, col and block (bit 0 = number 1)
+		int mGrid[81];
+		uint16_t mRowMasks[9];
+		uint16_t mColMasks[9];
+		uint16_t mBlockMasks[9];
+
+		// Extra constraints of the variant
+		Rules mRules;
+
+		// Random number generator to try candidates in random order (nullptr tries them in order)
+		std::minstd_rand* mRandom;
+
+		// Solutions found by the current search, the number to stop at, and the first solution
+		int mSolutions;
+		int mLimit;
+		int mSolution[81];
+
+		// Statistics of the last search (only recorded when SUDOKU_SOLVER_STATS is defined)
+		SolverStats mStats;
+
+		// Limits of the current search, its status and the nodes left until the limits are checked again
+		SolveLimits mLimits;
+		SolveStatus mStatus;
+		unsigned int mNodesUntilCheck;
+
+	private:
+		// Get candidates of an empty cell
+		inline uint16_t getCandidates(const int cell) const;
+
+		// Place and remove a number, keeping masks and rules up to date
+		inline void place(const int cell, const int num);
+		inline void remove(const int cell, const int num);
+
+		// Backtracking search, filling the cell with the fewest candidates first (returns true once the limit is reached or the search is stopped)
+		bool search(const int depth);
+
+	public:
+		// Constructor
+		VariantSolver();
+
+		// Get rules to set puzzle-specific constraints (such as killer cages) before setting the grid
+		Rules& getRules();
+
+		// Set grid to solve (0 for empty cells), returning false if the givens already break a rule
+		bool setGrid(const int* grid);
+
+		// Set random number generator to try candidates in random order (nullptr for in order)
+		void setRandom(std::minstd_rand* random);
+
+		// Find the first solution (the grid set is not changed)
+		bool solve(int* solution, const SolveLimits& limits = SolveLimits());
+
+		// Count solutions up to a limit (a limit of 2 checks that a solution is unique)
+		int countSolutions(const int limit, const SolveLimits& limits = SolveLimits());
+
+		// Get status of the last search (CANCELLED or TIMED_OUT if it was stopped, with the solutions counted so far)
+		SolveStatus getStatus() const;
+
+		// Get statistics of the last search, partial if it was stopped (all zero unless SUDOKU_SOLVER_STATS is defined)
+		const SolverStats& getStats() const;
+
+	};
+
+	template <class Rules>
+	class VariantGenerator
+	{
+	private:
+		// Random seed (the same seed generates the same Sudoku) and the generator's own random numbers
+		unsigned int mSeed;
+		std::minstd_rand mRandom;
+
+		// Rules of the last generated Sudoku (with any puzzle-specific constraints such as killer cages)
+		Rules mRules;
+
+		// Solver statistics aggregated over the last generate call
+		SolverStats mStats;
+
+	public:
+		// Constructor
+		VariantGenerator();
+
+		// Set and get random seed
+		void setSeed(const unsigned int seed);
+		unsigned int getSeed() const;
+
+		// Generate a Sudoku with a unique solution by removing clues from a random completed grid
+		void generate(int* grid, int* solutionGrid);
+
+		// Generate a Sudoku until cancelled or past the deadline (grid is not a valid puzzle if stopped)
+		SolveStatus generate(int* grid, int* solutionGrid, const SolveLimits& limits);
+
+		// Get rules of the last generated Sudoku
+		const Rules& getRules() const;
+
+		// Get solver statistics aggregated over the last generate call (all zero unless SUDOKU_SOLVER_STATS is defined)
+		const SolverStats& getStats() const;
+
+	};
+
+};
+
+template <class Rules>
+Sudoku::VariantSolver<Rules>::VariantSolver()
+	: mGrid(), mRowMasks(), mColMasks(), mBlockMasks(),
+	  mRandom(nullptr), mSolutions(0), mLimit(1), mSolution(),
+	  mStatus(SolveStatus::NO_SOLUTION), mNodesUntilCheck(SolveLimits::CHECK_INTERVAL)
+{
+
+}
+
+template <class Rules>
+inline uint16_t Sudoku::VariantSolver<Rules>::getCandidates(const int cell) const
+{
+	const int row = cell / 9;
+	const int col = cell % 9;
+	return (uint16_t)~(mRowMasks[row] | mColMasks[col] | mBlockMasks[(row / 3) * 3 + col / 3]) & 0x1FF & mRules.allowed(cell);
+}
+
+template <class Rules>
+inline void Sudoku::VariantSolver<Rules>::place(const int cell, const int num)
+{
+	const int row = cell / 9;
+	const int col = cell % 9;
+	const uint16_t bit = (uint16_t)(1u << (num - 1));
+	mGrid[cell] = num;
+	mRowMasks[row] |= bit;
+	mColMasks[col] |= bit;
+	mBlockMasks[(row / 3) * 3 + col / 3] |= bit;
+	mRules.place(cell, num);
+}
+
+template <class Rules>
+inline void Sudoku::VariantSolver<Rules>::remove(const int cell, const int num)
+{
+	const int row = cell / 9;
+	const int col = cell % 9;
+	const uint16_t bit = (uint16_t)~(1u << (num - 1));
+	mGrid[cell] = 0;
+	mRowMasks[row] &= bit;
+	mColMasks[col] &= bit;
+	mBlockMasks[(row / 3) * 3 + col / 3] &= bit;
+	mRules.remove(cell, num);
+}
+
+template <class Rules>
+bool Sudoku::VariantSolver<Rules>::search(const int depth)
+{
+	SUDOKU_STAT(mStats.maxDepth = depth > mStats.maxDepth ? depth : mStats.maxDepth);
+
+	// Find the empty cell with the fewest candidates
+	int bestCell = -1;
+	int bestCount = 10;
+	uint16_t bestCandidates = 0;
+	for (int cell = 0; cell < 81 && bestCount > 1; cell++)
+	{
+		if (mGrid[cell] != 0)
+		{
+			continue;
+		}
+		const uint16_t candidates = getCandidates(cell);
+		SUDOKU_STAT(mStats.propagations++);
+		int count = 0;
+		for (uint16_t bits = candidates; bits != 0; bits &= bits - 1)
+		{
+			count++;
+		}
+		if (count == 0)
+		{
+			return false;
+		}
+		if (count < bestCount)
+		{
+			bestCell = cell;
+			bestCount = count;
+			bestCandidates = candidates;
+		}
+	}
+
+	// Solution found
+	if (bestCell < 0)
+	{
+		if (mSolutions == 0)
+		{
+			for (int i = 0; i < 81; i++)
+			{
+				mSolution[i] = mGrid[i];
+			}
+		}
+		mSolutions++;
+		return mSolutions >= mLimit;
+	}
+
+	uint16_t remaining = bestCandidates;
+	while (remaining != 0)
+	{
+		// Take the lowest candidate, or a random one
+		uint16_t bit = remaining & (uint16_t)(0u - remaining);
+		if (mRandom != nullptr && bestCount > 1)
+		{
+			int skip = (int)((*mRandom)() % (unsigned int)bestCount);
+			for (bit = remaining & (uint16_t)(0u - remaining); skip > 0; skip--)
+			{
+				const uint16_t rest = remaining & (uint16_t)~((bit << 1) - 1);
+				bit = rest & (uint16_t)(0u - rest);
+			}
+		}
+		remaining &= (uint16_t)~bit;
+		bestCount--;
+
+		int num = 1;
+		while (!(bit & (1u << (num - 1))))
+		{
+			num++;
+		}
+
+		// Check the limits every few thousand nodes (the count carries over between searches)
+		if (--mNodesUntilCheck == 0)
+		{
+			mNodesUntilCheck = SolveLimits::CHECK_INTERVAL;
+			if (mLimits.reached(mStatus))
+			{
+				return true;
+			}
+		}
+
+		place(bestCell, num);
+		SUDOKU_STAT(mStats.nodes++);
+		const bool done = search(depth + 1);
+		remove(bestCell, num);
+		if (done)
+		{
+			return true;
+		}
+		SUDOKU_STAT(mStats.backtracks++);
+	}
+	return false;
+}
+
+template <class Rules>
+Rules& Sudoku::VariantSolver<Rules>::getRules()
+{
+	return mRules;
+}
+
+template <class Rules>
+bool Sudoku::VariantSolver<Rules>::setGrid(const int* grid)
+{
+	for (int i = 0; i < 9; i++)
+	{
+		mRowMasks[i] = 0;
+		mColMasks[i] = 0;
+		mBlockMasks[i] = 0;
+	}
+	mRules.reset();
+
+	bool valid = true;
+	for (int cell = 0; cell < 81; cell++)
+	{
+		mGrid[cell] = 0;
+	}
+	for (int cell = 0; cell < 81; cell++)
+	{
+		const int num = grid[cell];
+		if (num >= 1 && num <= 9)
+		{
+			valid = valid && (getCandidates(cell) & (1u << (num - 1))) != 0;
+			place(cell, num);
+		}
+	}
+	return valid;
+}
+
+template <class Rules>
+void Sudoku::VariantSolver<Rules>::setRandom(std::minstd_rand* random)
+{
+	mRandom = random;
+}
+
+template <class Rules>
+bool Sudoku::VariantSolver<Rules>::solve(int* solution, const SolveLimits& limits)
+{
+	if (countSolutions(1, limits) == 0)
+	{
+		return false;
+	}
+	for (int i = 0; i < 81; i++)
+	{
+		solution[i] = mSolution[i];
+	}
+	return true;
+}
+
+template <class Rules>
+int Sudoku::VariantSolver<Rules>::countSolutions(const int limit, const SolveLimits& limits)
+{
+	// Reset statistics and time the whole search
+	SUDOKU_STAT(mStats.reset());
+	SUDOKU_STAT(mStats.solves = 1);
+	SUDOKU_STAT(SolverStopwatch stopwatch);
+
+	mSolutions = 0;
+	mLimit = limit;
+	mLimits = limits;
+	mStatus = SolveStatus::NO_SOLUTION;
+	search(0);
+	if (mStatus == SolveStatus::NO_SOLUTION && mSolutions > 0)
+	{
+		mStatus = SolveStatus::SOLVED;
+	}
+
+	SUDOKU_STAT(mStats.wallTime = stopwatch.elapsed());
+	return mSolutions;
+}
+
+template <class Rules>
+Sudoku::SolveStatus Sudoku::VariantSolver<Rules>::getStatus() const
+{
+	return mStatus;
+}
+
+template <class Rules>
+const Sudoku::SolverStats& Sudoku::VariantSolver<Rules>::getStats() const
+{
+	return mStats;
+}
+
+template <class Rules>
+Sudoku::VariantGenerator<Rules>::VariantGenerator()
+	: mSeed(0)
+{
+
+}
+
+template <class Rules>
+void Sudoku::VariantGenerator<Rules>::setSeed(const unsigned int seed)
+{
+	mSeed = seed;
+}
+
+template <class Rules>
+unsigned int Sudoku::VariantGenerator<Rules>::getSeed() const
+{
+	return mSeed;
+}
+
+template <class Rules>
+void Sudoku::VariantGenerator<Rules>::generate(int* grid, int* solutionGrid)
+{
+	generate(grid, solutionGrid, SolveLimits());
+}
+
+template <class Rules>
+Sudoku::SolveStatus Sudoku::VariantGenerator<Rules>::generate(int* grid, int* solutionGrid, const SolveLimits& limits)
+{
+	mRandom.seed(mSeed);
+	SUDOKU_STAT(mStats.reset());
+
+	// 1. Fill an empty grid in random order for a random completed grid that follows the rules
+	VariantSolver<Rules> solver;
+	const int empty[81] = { };
+	solver.setRandom(&mRandom);
+	solver.setGrid(empty);
+	solver.solve(solutionGrid, limits);
+	SUDOKU_STAT(mStats.add(solver.getStats()));
+	if (solver.getStatus() != SolveStatus::SOLVED)
+	{
+		return solver.getStatus();
+	}
+
+	// 2. Set up puzzle-specific constraints from the completed grid
+	mRules = Rules();
+	mRules.prepare(solutionGrid, mRandom);
+	solver.getRules() = mRules;
+	solver.setRandom(nullptr);
+
+	// 3. Remove clues in random order, keeping each removal only if the solution stays unique
+	int order[81];
+	for (int i = 0; i < 81; i++)
+	{
+		grid[i] = solutionGrid[i];
+		order[i] = i;
+	}
+	for (int i = 80; i > 0; i--)
+	{
+		const int j = (int)(mRandom() % (unsigned int)(i + 1));
+		const int swap = order[i];
+		order[i] = order[j];
+		order[j] = swap;
+	}
+	for (int i = 0; i < 81; i++)
+	{
+		const int cell = order[i];
+		const int num = grid[cell];
+		grid[cell] = 0;
+		solver.setGrid(grid);
+		const int solutions = solver.countSolutions(2, limits);
+		SUDOKU_STAT(mStats.add(solver.getStats()));
+		if (solver.getStatus() == SolveStatus::CANCELLED || solver.getStatus() == SolveStatus::TIMED_OUT)
+		{
+			grid[cell] = num;
+			return solver.getStatus();
+		}
+		if (solutions != 1)
+		{
+			grid[cell] = num;
+		}
+	}
+	return SolveStatus::SOLVED;
+}
+
+template <class Rules>
+const Rules& Sudoku::VariantGenerator<Rules>::getRules() const
+{
+	return mRules;
+}
+
+template <class Rules>
+const Sudoku::SolverStats& Sudoku::VariantGenerator<Rules>::getStats() const
+{
+	return mStats;
+}
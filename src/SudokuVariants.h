@@ -0,0 +1,322 @@
+/* Variant rules as compile-time constraint policies for the variant solver and generator */
+#pragma once
+#include <random>
+#include <stdint.h>
+
+namespace Sudoku
+{
+	// Variants that can be played
+	enum class Variant
+	{
+		CLASSIC = 0,
+		DIAGONAL = 1,
+		WINDOKU = 2,
+		KILLER = 3,
+		TOTAL_VARIANTS = 4
+	};
+
+	// A rules policy adds constraints on top of rows, cols and blocks:
+	//   reset()                    forget all placed numbers
+	//   allowed(cell)              mask of numbers the policy allows in an empty cell (bit 0 = number 1)
+	//   place(cell, num)           a number was placed
+	//   remove(cell, num)          a placed number was removed
+	//   prepare(solution, random)  set up puzzle-specific constraints from a completed grid before clues are removed
+	// Every function is inline, so policies without constraints compile away completely.
+
+	// No extra constraints (the classic game)
+	struct ClassicRules
+	{
+		void reset() { }
+		uint16_t allowed(const int) const { return 0x1FF; }
+		void place(const int, const int) { }
+		void remove(const int, const int) { }
+		void prepare(const int*, std::minstd_rand&) { }
+	};
+
+	// Numbers can't repeat on either main diagonal (X-Sudoku)
+	struct DiagonalRules
+	{
+		uint16_t masks[2] = { 0, 0 };
+
+		// Check if a cell is on the main diagonal (0) or the anti-diagonal (1)
+		static bool onDiagonal(const int cell, const int diagonal)
+		{
+			return diagonal == 0 ? cell / 9 == cell % 9 : cell / 9 + cell % 9 == 8;
+		}
+
+		void reset()
+		{
+			masks[0] = 0;
+			masks[1] = 0;
+		}
+
+		uint16_t allowed(const int cell) const
+		{
+			return (uint16_t)~((onDiagonal(cell, 0) ? masks[0] : 0) | (onDiagonal(cell, 1) ? masks[1] : 0)) & 0x1FF;
+		}
+
+		void place(const int cell, const int num)
+		{
+			for (int diagonal = 0; diagonal < 2; diagonal++)
+			{
+				if (onDiagonal(cell, diagonal)) masks[diagonal] |= (uint16_t)(1u << (num - 1));
+			}
+		}
+
+		void remove(const int cell, const int num)
+		{
+			for (int diagonal = 0; diagonal < 2; diagonal++)
+			{
+				if (onDiagonal(cell, diagonal)) masks[diagonal] &= (uint16_t)~(1u << (num - 1));
+			}
+		}
+
+		void prepare(const int*, std::minstd_rand&) { }
+	};
+
+	// Numbers can't repeat in four extra 3 x 3 windows (Windoku)
+	struct WindokuRules
+	{
+		uint16_t masks[4] = { 0, 0, 0, 0 };
+
+		// Get window of a cell (-1 if it is not in one); windows start at rows and cols 1 and 5
+		static int getWindow(const int cell)
+		{
+			const int row = cell / 9;
+			const int col = cell % 9;
+			const int windowRow = row >= 1 && row <= 3 ? 0 : (row >= 5 && row <= 7 ? 1 : -1);
+			const int windowCol = col >= 1 && col <= 3 ? 0 : (col >= 5 && col <= 7 ? 1 : -1);
+			return windowRow >= 0 && windowCol >= 0 ? windowRow * 2 + windowCol : -1;
+		}
+
+		void reset()
+		{
+			for (int i = 0; i < 4; i++) masks[i] = 0;
+		}
+
+		uint16_t allowed(const int cell) const
+		{
+			const int window = getWindow(cell);
+			return window >= 0 ? (uint16_t)~masks[window] & 0x1FF : 0x1FF;
+		}
+
+		void place(const int cell, const int num)
+		{
+			const int window = getWindow(cell);
+			if (window >= 0) masks[window] |= (uint16_t)(1u << (num - 1));
+		}
+
+		void remove(const int cell, const int num)
+		{
+			const int window = getWindow(cell);
+			if (window >= 0) masks[window] &= (uint16_t)~(1u << (num - 1));
+		}
+
+		void prepare(const int*, std::minstd_rand&) { }
+	};
+
+	// Cells are grouped into cages whose numbers can't repeat and must add up to the cage sum (Killer Sudoku)
+	struct KillerRules
+	{
+		// Cage of every cell and the sum and size of every cage (there are at most 81 cages)
+		uint8_t cageOf[81] = { };
+		uint8_t sums[81] = { };
+		uint8_t sizes[81] = { };
+		int totalCages = 0;
+
+		// Numbers placed in every cage, their sum and count
+		uint16_t used[81] = { };
+		uint8_t placedSums[81] = { };
+		uint8_t placedCounts[81] = { };
+
+		// Set cages from the cage of every cell and compute sums from a completed grid
+		void setCages(const uint8_t* cages, const int* solution)
+		{
+			totalCages = 0;
+			for (int i = 0; i < 81; i++)
+			{
+				sums[i] = 0;
+				sizes[i] = 0;
+			}
+			for (int cell = 0; cell < 81; cell++)
+			{
+				cageOf[cell] = cages[cell];
+				sums[cages[cell]] = (uint8_t)(sums[cages[cell]] + solution[cell]);
+				sizes[cages[cell]]++;
+				totalCages = cages[cell] + 1 > totalCages ? cages[cell] + 1 : totalCages;
+			}
+			reset();
+		}
+
+		void reset()
+		{
+			for (int i = 0; i < 81; i++)
+			{
+				used[i] = 0;
+				placedSums[i] = 0;
+				placedCounts[i] = 0;
+			}
+		}
+
+		uint16_t allowed(const int cell) const
+		{
+			// Anything goes until cages are set (while the completed grid is being made)
+			if (totalCages == 0)
+			{
+				return 0x1FF;
+			}
+
+			// Leave enough of the sum for the smallest distinct numbers in the other empty cells
+			const int cage = cageOf[cell];
+			const int empty = sizes[cage] - placedCounts[cage];
+			const int remaining = sums[cage] - placedSums[cage];
+			if (empty == 1)
+			{
+				return remaining >= 1 && remaining <= 9 ? (uint16_t)(1u << (remaining - 1)) & (uint16_t)~used[cage] : 0;
+			}
+			const int largest = remaining - (empty - 1) * empty / 2;
+			const uint16_t fits = largest >= 9 ? 0x1FF : (largest <= 0 ? 0 : (uint16_t)((1u << largest) - 1));
+			return fits & (uint16_t)~used[cage];
+		}
+
+		void place(const int cell, const int num)
+		{
+			const int cage = cageOf[cell];
+			used[cage] |= (uint16_t)(1u << (num - 1));
+			placedSums[cage] = (uint8_t)(placedSums[cage] + num);
+			placedCounts[cage]++;
+		}
+
+		void remove(const int cell, const int num)
+		{
+			const int cage = cageOf[cell];
+			used[cage] &= (uint16_t)~(1u << (num - 1));
+			placedSums[cage] = (uint8_t)(placedSums[cage] - num);
+			placedCounts[cage]--;
+		}
+
+		void prepare(const int* solution, std::minstd_rand& random)
+		{
+			// Grow cages of 2 to 4 cells from cells in random order, never repeating a number in a cage
+			uint8_t cages[81];
+			for (int i = 0; i < 81; i++) cages[i] = 0xFF;
+			int order[81];
+			for (int i = 0; i < 81; i++) order[i] = i;
+			for (int i = 80; i > 0; i--)
+			{
+				const int j = (int)(random() % (unsigned int)(i + 1));
+				const int swap = order[i];
+				order[i] = order[j];
+				order[j] = swap;
+			}
+
+			int cage = 0;
+			for (int i = 0; i < 81; i++)
+			{
+				if (cages[order[i]] != 0xFF) continue;
+
+				int cells[4] = { order[i] };
+				int size = 1;
+				uint16_t numbers = (uint16_t)(1u << (solution[order[i]] - 1));
+				cages[order[i]] = (uint8_t)cage;
+				const int target = 2 + (int)(random() % 3);
+				while (size < target)
+				{
+					// Pick a random free neighbour of any cell in the cage
+					int candidates[16];
+					int totalCandidates = 0;
+					for (int c = 0; c < size; c++)
+					{
+						const int row = cells[c] / 9;
+						const int col = cells[c] % 9;
+						const int neighbours[4] = { row > 0 ? cells[c] - 9 : -1, row < 8 ? cells[c] + 9 : -1, col > 0 ? cells[c] - 1 : -1, col < 8 ? cells[c] + 1 : -1 };
+						for (int n = 0; n < 4; n++)
+						{
+							if (neighbours[n] >= 0 && cages[neighbours[n]] == 0xFF && !(numbers & (1u << (solution[neighbours[n]] - 1))))
+							{
+								candidates[totalCandidates++] = neighbours[n];
+							}
+						}
+					}
+					if (totalCandidates == 0) break;
+
+					const int next = candidates[random() % (unsigned int)totalCandidates];
+					cages[next] = (uint8_t)cage;
+					numbers |= (uint16_t)(1u << (solution[next] - 1));
+					cells[size++] = next;
+				}
+				cage++;
+			}
+			setCages(cages, solution);
+		}
+	};
+
+	// Constraints of two policies together (nest to combine more)
+	template <class First, class Second>
+	struct CombinedRules
+	{
+		First first;
+		Second second;
+
+		void reset() { first.reset(); second.reset(); }
+		uint16_t allowed(const int cell) const { return first.allowed(cell) & second.allowed(cell); }
+		void place(const int cell, const int num) { first.place(cell, num); second.place(cell, num); }
+		void remove(const int cell, const int num) { first.remove(cell, num); second.remove(cell, num); }
+		void prepare(const int* solution, std::minstd_rand& random) { first.prepare(solution, random); second.prepare(solution, random); }
+	};
+
+	// Constraints of a variant chosen at run time (for code that handles every variant, such as the game itself)
+	struct VariantRules
+	{
+		Variant variant = Variant::CLASSIC;
+		DiagonalRules diagonal;
+		WindokuRules windoku;
+		KillerRules killer;
+
+		void reset()
+		{
+			diagonal.reset();
+			windoku.reset();
+			killer.reset();
+		}
+
+		uint16_t allowed(const int cell) const
+		{
+			switch (variant)
+			{
+			case Variant::DIAGONAL: return diagonal.allowed(cell);
+			case Variant::WINDOKU: return windoku.allowed(cell);
+			case Variant::KILLER: return killer.allowed(cell);
+			default: return 0x1FF;
+			}
+		}
+
+		void place(const int cell, const int num)
+		{
+			switch (variant)
+			{
+			case Variant::DIAGONAL: diagonal.place(cell, num); break;
+			case Variant::WINDOKU: windoku.place(cell, num); break;
+			case Variant::KILLER: killer.place(cell, num); break;
+			default: break;
+			}
+		}
+
+		void remove(const int cell, const int num)
+		{
+			switch (variant)
+			{
+			case Variant::DIAGONAL: diagonal.remove(cell, num); break;
+			case Variant::WINDOKU: windoku.remove(cell, num); break;
+			case Variant::KILLER: killer.remove(cell, num); break;
+			default: break;
+			}
+		}
+
+		void prepare(const int* solution, std::minstd_rand& random)
+		{
+			if (variant == Variant::KILLER) killer.prepare(solution, random);
+		}
+	};
+
+};
@@ -1,12 +1,310 @@
 #include "Sudoku.h"
+#include "SudokuPuzzleIO.h"
+#include "SudokuGenerationFarm.h"
+#include "SudokuService.h"
+#include "SudokuFuzzer.h"
+#include "SudokuLowClueSearch.h"
+#include "SudokuParallelCounter.h"
+#include <chrono>
+#include <signal.h>
+
+namespace
+{
+	// Service stopped by stopService while --serve runs
+	Sudoku::PuzzleService* gService = nullptr;
+
+	// Signal handler asking the service to stop
+	void stopService(int)
+	{
+		if (gService != nullptr)
+		{
+			gService->requestStop();
+		}
+	}
+
+	// Assets packed into the asset archive
+	const char* const gAssetNames[] =
+	{
+		"octin sports free.ttf", "effect.wav", "new_game.wav", "win.wav", "checksolution.wav", "loop_music.mp3"
+	};
+
+	// Solve every puzzle of a file, writing solutions (unsolvable puzzles are written unchanged)
+	int solvePuzzles(const std::string& inputPath, const std::string& outputPath)
+	{
+		Sudoku::PuzzleReader reader;
+		Sudoku::PuzzleWriter writer;
+		if (!reader.open(inputPath) || !writer.open(outputPath))
+		{
+			std::cerr << "Could not open " << inputPath << " or " << outputPath << std::endl;
+			return 1;
+		}
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Sudoku::Solver solver;
+		int grid[81];
+		int total = 0;
+		int solved = 0;
+		while (reader.next(grid))
+		{
+			solver.setGrid(grid);
+			solved += solver.solve() ? 1 : 0;
+			total++;
+
+			int commentLength;
+			const char* comment = reader.getComment(commentLength);
+			writer.write(grid, comment, commentLength);
+		}
+		const bool written = writer.close();
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		// Report on standard error so solutions can be written to standard output
+		std::cerr << "Solved " << solved << " of " << total << " puzzles in " << seconds << " s (" << reader.getSkipped() << " malformed lines skipped)" << std::endl;
+		return written ? 0 : 1;
+	}
+
+	// Generate unique puzzles on several threads into sharded files with a manifest of per-shard counts and timing
+	int generateBatch(const int64_t total, const int threads, const std::string& prefix, const unsigned int firstSeed)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Sudoku::GenerationFarm farm;
+		const bool complete = farm.run(total, threads, prefix, firstSeed);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		const bool written = farm.writeManifest(prefix + ".manifest", seconds);
+		std::cerr << "Generated " << total << " puzzles on " << threads << " threads in " << seconds << " s" << std::endl;
+		return complete && written ? 0 : 1;
+	}
+
+	// Check solver backends, the hint engine and the generators against the reference solver on random cases
+	int fuzzBackends(const int64_t cases, const int threads, const unsigned int seed)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Sudoku::DifferentialFuzzer fuzzer;
+		const bool passed = fuzzer.run(cases, threads, seed);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::cerr << "Ran " << fuzzer.getCases() << " cases on " << threads << " threads in " << seconds << " s (" << (int64_t)(fuzzer.getCases() / (seconds > 0.0 ? seconds : 1.0)) << " per second, seed " << seed << ", "
+			<< fuzzer.getSkipped() << " skipped, " << fuzzer.getFailures() << " failed)" << std::endl;
+		if (!passed)
+		{
+			std::cerr << "First failure: " << fuzzer.getFirstFailure() << std::endl;
+		}
+		return passed ? 0 : 1;
+	}
+
+	// Search for puzzles with as few clues as possible, writing every puzzle that matched the fewest clues found so far
+	int searchLowClues(const double seconds, const int threads, const std::string& outputPath, const unsigned int seed, const int targetClues)
+	{
+		Sudoku::LowClueSearch search;
+		search.run(seconds, threads, seed, targetClues);
+		const bool written = search.writePuzzles(outputPath);
+
+		std::cerr << "Fewest clues " << search.getBestClues() << " (" << search.getPuzzles().size() << " puzzles) from " << search.getGrids() << " grids and " << search.getChecks() << " uniqueness checks ("
+			<< (int64_t)(search.getChecks() / (seconds > 0.0 ? seconds : 1.0)) << " per second on " << threads << " threads)" << std::endl;
+		std::cerr << "Clues of the first minimal puzzle of each grid:";
+		for (int clues = 0; clues <= 81; clues++)
+		{
+			if (search.getMinimalCount(clues) > 0)
+			{
+				std::cerr << " " << clues << ":" << search.getMinimalCount(clues);
+			}
+		}
+		std::cerr << std::endl;
+		return written ? 0 : 1;
+	}
+
+	// Count solutions of every puzzle of a file on several threads, writing one count per line (a budget of 0 seconds means none)
+	int countSolutions(const std::string& inputPath, const int threads, const double seconds)
+	{
+		Sudoku::PuzzleReader reader;
+		if (!reader.open(inputPath))
+		{
+			std::cerr << "Could not open " << inputPath << std::endl;
+			return 1;
+		}
+
+		Sudoku::ParallelCounter counter;
+		int grid[81];
+		int total = 0;
+		int finished = 0;
+		Sudoku::GridCount solutions;
+		double totalSeconds = 0.0;
+		while (reader.next(grid))
+		{
+			const Sudoku::SolveLimits limits = seconds > 0.0 ? Sudoku::SolveLimits::budget(seconds * 1000.0) : Sudoku::SolveLimits();
+			const Sudoku::GridCount count = counter.run(grid, threads, limits, true);
+			const bool complete = counter.getStatus() == Sudoku::SolveStatus::SOLVED || counter.getStatus() == Sudoku::SolveStatus::NO_SOLUTION;
+			std::cout << count.toString() << (complete ? "" : " (timed out, at least)") << std::endl;
+			std::cerr << "Line " << reader.getLine() << ": " << count.toString() << " solutions in " << counter.getSeconds() << " s" << std::endl;
+			total++;
+			finished += complete ? 1 : 0;
+			solutions.add(count);
+			totalSeconds += counter.getSeconds();
+		}
+
+		std::cerr << "Counted " << finished << " of " << total << " puzzles on " << threads << " threads in " << totalSeconds << " s ("
+			<< (totalSeconds > 0.0 ? solutions.toDouble() / totalSeconds : 0.0) << " solutions per second)" << std::endl;
+		return finished == total ? 0 : 1;
+	}
+
+	// Replay recorded input headlessly and report frame timing, failing if the 99th percentile of the work of a frame is over budget (0 for no budget);
+	// the frame time includes the sleep that paces frames, so it is only reported
+	int replayInput(const std::string& inputPath, const std::string& framesPath, const double frameBudget)
+	{
+		Sudoku::Sudoku S;
+		if (!S.replayInput(inputPath))
+		{
+			return 1;
+		}
+		S.play();
+
+		const Sudoku::InputReplay& replay = S.getReplay();
+		const char* const phaseNames[] = { "Frame", "Events", "Logic", "Render", "Present" };
+		std::cout << "Replayed " << replay.getTotalFrames() << " frames of " << inputPath << (replay.isFinished() ? "" : " (stopped before the end)") << std::endl;
+		for (int phase = 0; phase < (int)Sudoku::FramePhase::TOTAL_PHASES; phase++)
+		{
+			const Sudoku::PhaseSummary summary = replay.getSummary((Sudoku::FramePhase)phase);
+			char line[128];
+			snprintf(line, sizeof(line), "%-8s min %7.3f  avg %7.3f  p99 %7.3f  max %7.3f ms", phaseNames[phase], summary.min, summary.avg, summary.p99, summary.max);
+			std::cout << line << std::endl;
+		}
+		const Sudoku::PhaseSummary work = replay.getWorkSummary();
+		char workLine[128];
+		snprintf(workLine, sizeof(workLine), "%-8s min %7.3f  avg %7.3f  p99 %7.3f  max %7.3f ms", "Work", work.min, work.avg, work.p99, work.max);
+		std::cout << workLine << std::endl;
+
+		// A replay that never got past the menu has nothing to time
+		bool passed = replay.isFinished();
+		if (replay.getTotalFrames() == 0)
+		{
+			std::cout << "No game frames were timed" << std::endl;
+			passed = false;
+		}
+		if (!framesPath.empty())
+		{
+			passed = replay.writeFrames(framesPath) && passed;
+		}
+		if (frameBudget > 0.0 && work.p99 > frameBudget)
+		{
+			std::cout << "Frame work p99 " << work.p99 << " ms is over the " << frameBudget << " ms budget" << std::endl;
+			passed = false;
+		}
+		return passed ? 0 : 1;
+	}
+}
 
 int main(int argc, char* argv[])
 {
+	// Solve puzzles from a file: --solve input output (- for standard output)
+	if (argc >= 4 && strcmp(argv[1], "--solve") == 0)
+	{
+		return solvePuzzles(argv[2], argv[3]);
+	}
+
+	// Run the puzzle service: --serve [port] [threads] [request budget in milliseconds]
+	if (argc >= 2 && strcmp(argv[1], "--serve") == 0)
+	{
+		const int port = argc >= 3 ? atoi(argv[2]) : 7390;
+		const int threads = argc >= 4 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+		const int requestBudget = argc >= 5 ? atoi(argv[4]) : Sudoku::PuzzleService::DEFAULT_REQUEST_BUDGET;
+		Sudoku::PuzzleService service;
+		if (!service.start(port, threads, requestBudget))
+		{
+			return 1;
+		}
+
+		// Ctrl+C or a termination signal stops the service cleanly
+		gService = &service;
+		signal(SIGINT, stopService);
+		signal(SIGTERM, stopService);
+		std::cerr << "Serving puzzles on 127.0.0.1:" << port << std::endl;
+		service.wait();
+		service.stop();
+		gService = nullptr;
+		std::cerr << "Answered " << service.getRequests() << " requests" << std::endl;
+		return 0;
+	}
+
+	// Generate a batch of puzzles: --generate-batch count threads prefix [first seed]
+	if (argc >= 5 && strcmp(argv[1], "--generate-batch") == 0)
+	{
+		const unsigned int firstSeed = argc >= 6 ? (unsigned int)strtoul(argv[5], nullptr, 10) : (unsigned int)time(NULL);
+		return generateBatch(strtoll(argv[2], nullptr, 10), atoi(argv[3]), argv[4], firstSeed);
+	}
+
+	// Fuzz the solvers against each other: --fuzz [cases] [threads] [seed]
+	if (argc >= 2 && strcmp(argv[1], "--fuzz") == 0)
+	{
+		const int64_t cases = argc >= 3 ? strtoll(argv[2], nullptr, 10) : 1000000;
+		const int threads = argc >= 4 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+		const unsigned int seed = argc >= 5 ? (unsigned int)strtoul(argv[4], nullptr, 10) : (unsigned int)time(NULL);
+		return fuzzBackends(cases, threads, seed);
+	}
+
+	// Search for low-clue puzzles: --low-clue [seconds] [threads] [output] [seed] [target clues]
+	if (argc >= 2 && strcmp(argv[1], "--low-clue") == 0)
+	{
+		const double seconds = argc >= 3 ? atof(argv[2]) : 60.0;
+		const int threads = argc >= 4 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+		const std::string outputPath = argc >= 5 ? argv[4] : "-";
+		const unsigned int seed = argc >= 6 ? (unsigned int)strtoul(argv[5], nullptr, 10) : (unsigned int)time(NULL);
+		const int targetClues = argc >= 7 ? atoi(argv[6]) : 17;
+		return searchLowClues(seconds, threads, outputPath, seed, targetClues);
+	}
+
+	// Count solutions of sparse puzzles: --count input [threads] [seconds per puzzle]
+	if (argc >= 3 && strcmp(argv[1], "--count") == 0)
+	{
+		const int threads = argc >= 4 ? atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+		const double seconds = argc >= 5 ? atof(argv[4]) : 0.0;
+		return countSolutions(argv[2], threads, seconds);
+	}
+
+	// Pack assets into an archive: --pack-assets [assets folder] [archive]
+	if (argc >= 2 && strcmp(argv[1], "--pack-assets") == 0)
+	{
+		const std::string directory = argc >= 3 ? argv[2] : "assets";
+		const std::string path = argc >= 4 ? argv[3] : "assets.pak";
+		const int totalNames = sizeof(gAssetNames) / sizeof(gAssetNames[0]);
+		if (!Sudoku::AssetArchive::pack(path, directory, gAssetNames, totalNames, MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, MIX_DEFAULT_CHANNELS))
+		{
+			std::cout << "Failed to pack assets into " << path << std::endl;
+			return 1;
+		}
+		std::cout << "Packed " << totalNames << " assets into " << path << std::endl;
+		return 0;
+	}
+
+	// Replay recorded input without a display: --replay input [per-frame csv] [p99 budget of the work of a frame in milliseconds]
+	if (argc >= 3 && strcmp(argv[1], "--replay") == 0)
+	{
+		const std::string framesPath = argc >= 4 ? argv[3] : "";
+		const double frameBudget = argc >= 5 ? atof(argv[4]) : 0.0;
+		return replayInput(argv[2], framesPath, frameBudget);
+	}
+
 	// Create Sudoku game object
 	Sudoku::Sudoku S;
 
+	// Options while playing: --record output, --audio-buffer frames, --browse collection (in any order)
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--record") == 0)
+		{
+			S.recordInput(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--audio-buffer") == 0)
+		{
+			S.setAudioBufferSize(atoi(argv[i + 1]));
+		}
+		else if (strcmp(argv[i], "--browse") == 0)
+		{
+			S.openCollection(argv[i + 1]);
+		}
+	}
+
 	// Play Sudoku game
 	S.play();
 
 	return 0;
-}
\ No newline at end of file
+}